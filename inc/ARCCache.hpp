@@ -0,0 +1,222 @@
+#ifndef ARC_CACHE_HPP
+#define ARC_CACHE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <iostream>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+#include "InPlaceValue.hpp"
+
+namespace cache {
+
+template <typename T, typename KeyT>
+struct ARCCacheNode : InPlaceValue<T> {
+    KeyT key_;
+
+    template <typename F>
+        requires std::invocable<F &>
+    ARCCacheNode(const KeyT &key, F &&loadData)
+        : InPlaceValue<T>(loadData), key_(key) {}
+};
+
+template <typename T, typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+class ARCCache {
+    using ResidentList = std::list<ARCCacheNode<T, KeyT>>;
+    using GhostList = std::list<KeyT>;
+
+    struct ResidentEntry {
+        typename ResidentList::iterator it_;
+        bool frequent_; // true - node lives in t2_, false - in t1_
+    };
+
+    struct GhostEntry {
+        typename GhostList::iterator it_;
+        bool frequent_; // true - key lives in b2_, false - in b1_
+    };
+
+    // t1_ - residents seen once recently, t2_ - residents seen at least twice.
+    // b1_/b2_ - ghosts: keys recently evicted from t1_/t2_, data is dropped.
+    // Front of every list is the MRU position, back is the LRU position.
+    ResidentList t1_;
+    ResidentList t2_;
+    GhostList b1_;
+    GhostList b2_;
+
+    std::unordered_map<KeyT, ResidentEntry, Hash, Eq> hashTable_;
+    std::unordered_map<KeyT, GhostEntry, Hash, Eq> ghostTable_;
+
+    std::optional<InPlaceValue<T>> bypass_; // zero capacity
+
+    size_t p_ = 0; // adaptive target size of t1_
+    size_t capacity_ = 0;
+
+  private:
+    bool valid() const {
+        return t1_.size() + t2_.size() <= capacity_ &&
+               t1_.size() + b1_.size() <= capacity_ &&
+               t1_.size() + t2_.size() + b1_.size() + b2_.size() <=
+                   2 * capacity_ &&
+               hashTable_.size() == t1_.size() + t2_.size() &&
+               ghostTable_.size() == b1_.size() + b2_.size();
+    }
+
+    void pushGhost(const KeyT &key, bool frequent) {
+        GhostList &ghostList = frequent ? b2_ : b1_;
+        ghostList.push_front(key);
+        ghostTable_[key] = {ghostList.begin(), frequent};
+    }
+
+    void popGhostLRU(bool frequent) {
+        GhostList &ghostList = frequent ? b2_ : b1_;
+        assert(!ghostList.empty());
+
+        ghostTable_.erase(ghostList.back());
+        ghostList.pop_back();
+    }
+
+    void demoteLRU(bool frequent) {
+        ResidentList &residentList = frequent ? t2_ : t1_;
+        assert(!residentList.empty());
+
+        const KeyT &key = residentList.back().key_;
+        hashTable_.erase(key);
+        pushGhost(key, frequent);
+        residentList.pop_back();
+    }
+
+    // REPLACE subroutine: evicts LRU of t1_ or t2_ into the matching ghost
+    // list, depending on how t1_ relates to its target size p_.
+    void replace(bool hitInB2) {
+        if (!t1_.empty() &&
+            (t1_.size() > p_ || (hitInB2 && t1_.size() == p_)))
+            demoteLRU(false);
+        else
+            demoteLRU(true);
+    }
+
+    // Both miss paths load into a list of their own first: if loading
+    // throws, nothing has been adapted, demoted or dropped yet.
+    template <typename F> T *onGhostHit(const KeyT &key, F &loadData) {
+        ResidentList loaded;
+        loaded.emplace_front(key, loadData);
+
+        auto ghostIt = ghostTable_.find(key);
+        assert(ghostIt != ghostTable_.end());
+
+        bool frequent = ghostIt->second.frequent_;
+        if (frequent) {
+            size_t delta = std::max<size_t>(b1_.size() / b2_.size(), 1);
+            p_ = p_ > delta ? p_ - delta : 0;
+        } else {
+            size_t delta = std::max<size_t>(b2_.size() / b1_.size(), 1);
+            p_ = std::min(capacity_, p_ + delta);
+        }
+
+        // Drop the ghost before replace(): it may insert into ghostTable_ and
+        // invalidate ghostIt.
+        (frequent ? b2_ : b1_).erase(ghostIt->second.it_);
+        ghostTable_.erase(ghostIt);
+
+        replace(frequent);
+
+        t2_.splice(t2_.begin(), loaded);
+        hashTable_[key] = {t2_.begin(), true};
+        return std::addressof(t2_.front().data_);
+    }
+
+    template <typename F> T *onFullMiss(const KeyT &key, F &loadData) {
+        ResidentList loaded;
+        loaded.emplace_front(key, loadData);
+
+        size_t l1Size = t1_.size() + b1_.size();
+        size_t totalSize = l1Size + t2_.size() + b2_.size();
+
+        if (l1Size == capacity_) {
+            if (t1_.size() < capacity_) {
+                popGhostLRU(false);
+                replace(false);
+            } else {
+                hashTable_.erase(t1_.back().key_);
+                t1_.pop_back();
+            }
+        } else if (totalSize >= capacity_) {
+            if (totalSize == 2 * capacity_)
+                popGhostLRU(true);
+            replace(false);
+        }
+
+        t1_.splice(t1_.begin(), loaded);
+        hashTable_[key] = {t1_.begin(), false};
+        return std::addressof(t1_.front().data_);
+    }
+
+    // Returns the resident value for key and whether it was a hit. With
+    // zero capacity the value is only loaded if needValue, else it's null.
+    template <typename F>
+    std::pair<T *, bool> access(const KeyT &key, F &slowGetPage,
+                                bool needValue) {
+        auto loadData = [&] { return slowGetPage(key); };
+
+        if (capacity_ == 0) {
+            if (!needValue)
+                return {nullptr, false};
+            bypass_.emplace(loadData);
+            return {std::addressof(bypass_->data_), false};
+        }
+        assert(valid());
+
+        auto hashIt = hashTable_.find(key);
+        if (hashIt != hashTable_.end()) {
+            ResidentEntry &entry = hashIt->second;
+            t2_.splice(t2_.begin(), entry.frequent_ ? t2_ : t1_, entry.it_);
+            entry.frequent_ = true;
+            return {std::addressof(entry.it_->data_), true};
+        }
+
+        if (ghostTable_.contains(key))
+            return {onGhostHit(key, loadData), false};
+
+        return {onFullMiss(key, loadData), false};
+    }
+
+  public:
+    ARCCache(const size_t capacity) : capacity_(capacity) {}
+
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage, false).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> T &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage, true).first;
+    }
+
+    void print() const {
+        std::cout << "ARC CACHE:\n";
+        std::cout << "cap : " << capacity_ << '\n';
+        std::cout << "p   : " << p_ << '\n';
+
+        std::cout << "T1 : ";
+        for (auto &node : t1_)
+            std::cout << node.key_ << " ";
+        std::cout << "\nT2 : ";
+        for (auto &node : t2_)
+            std::cout << node.key_ << " ";
+        std::cout << "\nB1 : ";
+        for (auto &key : b1_)
+            std::cout << key << " ";
+        std::cout << "\nB2 : ";
+        for (auto &key : b2_)
+            std::cout << key << " ";
+        std::cout << "\n\n";
+    }
+};
+
+} // namespace cache
+
+#endif // ARC_CACHE_HPP
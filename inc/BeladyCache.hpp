@@ -3,14 +3,18 @@
 
 #include <algorithm>
 #include <cassert>
+#include <concepts>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "InPlaceValue.hpp"
+
 namespace cache {
 
 using QueryIteration = int;
@@ -20,12 +24,15 @@ constexpr inline QueryIteration MAX_QUERY_ITERATION =
 template <typename DataT, typename KeyT, typename Hash = std::hash<KeyT>,
           typename Eq = std::equal_to<KeyT>>
 class BeladyCache {
-    using ListIt = typename std::list<DataT>::iterator;
+    using ListIt = typename std::list<InPlaceValue<DataT>>::iterator;
 
     std::unordered_set<KeyT, Hash, Eq> keyStorage_;
 
     size_t capacity_ = 0;
-    std::list<DataT> cache_;
+    std::list<InPlaceValue<DataT>> cache_;
+
+    // Zero capacity, or the key is requested later than every resident.
+    std::optional<InPlaceValue<DataT>> bypass_;
 
     std::unordered_map<const KeyT *, ListIt> hashTable_;
     std::unordered_map<const KeyT *, std::queue<QueryIteration>>
@@ -87,6 +94,53 @@ class BeladyCache {
         return nullptr;
     }
 
+    // Returns the value for key (resident or bypassed) and whether it was a
+    // hit. A bypassed value is only loaded if needValue, else it's null.
+    template <typename F>
+    std::pair<DataT *, bool> access(const KeyT &key, F &slowGetPage,
+                                    bool needValue) {
+        auto loadData = [&] { return slowGetPage(key); };
+
+        if (capacity_ == 0) {
+            if (!needValue)
+                return {nullptr, false};
+            bypass_.emplace(loadData);
+            return {std::addressof(bypass_->data_), false};
+        }
+        assert(valid());
+
+        const KeyT *keyPtr = getKeyPtr(key);
+
+        updateQueryTable(keyPtr);
+
+        auto hashIt = hashTable_.find(keyPtr);
+        if (hashIt == hashTable_.end()) {
+            if (full()) {
+                const KeyT *subKey = getSubKey();
+                if (getActualKeyNextQueryIteration(subKey) <=
+                    getActualKeyNextQueryIteration(keyPtr)) {
+                    if (!needValue)
+                        return {nullptr, false};
+                    bypass_.emplace(loadData);
+                    return {std::addressof(bypass_->data_), false};
+                }
+
+                auto subIt = hashTable_.find(subKey);
+                cache_.erase(subIt->second);
+                hashTable_.erase(subIt);
+            }
+
+            cache_.emplace_front(loadData);
+            hashTable_[keyPtr] = cache_.begin();
+
+            keyQueue_.push({getActualKeyNextQueryIteration(keyPtr), keyPtr});
+            return {std::addressof(cache_.front().data_), false};
+        }
+
+        refreshKey(keyPtr);
+        return {std::addressof(hashIt->second->data_), true};
+    }
+
   public:
     template <typename IterT>
         requires std::same_as<typename std::iterator_traits<IterT>::value_type,
@@ -116,36 +170,12 @@ class BeladyCache {
     }
 
     template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
-        if (capacity_ == 0)
-            return false;
-        assert(valid());
-
-        const KeyT *keyPtr = getKeyPtr(key);
-
-        updateQueryTable(keyPtr);
-
-        if (!hashTable_.contains(keyPtr)) {
-            if (full()) {
-                const KeyT *subKey = getSubKey();
-                if (getActualKeyNextQueryIteration(subKey) <=
-                    getActualKeyNextQueryIteration(keyPtr))
-                    return false;
-
-                ListIt subPos = hashTable_[subKey];
-                *subPos = slowGetPage(key);
-                hashTable_.erase(subKey);
-                hashTable_[keyPtr] = subPos;
-            } else {
-                cache_.push_front(slowGetPage(key));
-                hashTable_[keyPtr] = cache_.begin();
-            }
-
-            keyQueue_.push({getActualKeyNextQueryIteration(keyPtr), keyPtr});
-            return false;
-        }
+        return access(key, slowGetPage, false).second;
+    }
 
-        refreshKey(keyPtr);
-        return true;
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> DataT &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage, true).first;
     }
 };
 
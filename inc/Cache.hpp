@@ -1,8 +1,15 @@
 #ifndef CACHE_HPP
 #define CACHE_HPP
 
+#include "ARCCache.hpp"
 #include "BeladyCache.hpp"
 #include "LFUCache.hpp"
+#include "OnlineBeladyCache.hpp"
+#include "S3FIFOCache.hpp"
+#include "SetAssocLFUCache.hpp"
+#include "SharedLFUCache.hpp"
+#include "StaticLFUCache.hpp"
+#include "TieredCache.hpp"
 
 template <typename T> struct CacheKeyType;
 
@@ -16,6 +23,43 @@ struct CacheKeyType<cache::BeladyCache<DataT, KeyT>> {
     using type = KeyT;
 };
 
+template <typename DataT, typename KeyT>
+struct CacheKeyType<cache::OnlineBeladyCache<DataT, KeyT>> {
+    using type = KeyT;
+};
+
+template <typename DataT, typename KeyT>
+struct CacheKeyType<cache::ARCCache<DataT, KeyT>> {
+    using type = KeyT;
+};
+
+template <typename DataT, typename KeyT>
+struct CacheKeyType<cache::S3FIFOCache<DataT, KeyT>> {
+    using type = KeyT;
+};
+
+template <typename DataT, typename KeyT, size_t N>
+struct CacheKeyType<cache::StaticLFUCache<DataT, KeyT, N>> {
+    using type = KeyT;
+};
+
+template <typename DataT, typename KeyT, size_t Ways>
+struct CacheKeyType<cache::SetAssocLFUCache<DataT, KeyT, Ways>> {
+    using type = KeyT;
+};
+
+template <typename DataT, typename KeyT>
+struct CacheKeyType<cache::TieredCache<DataT, KeyT>> {
+    using type = KeyT;
+};
+
+#ifdef CACHE_HAS_SHARED_MEMORY
+template <typename DataT, typename KeyT, size_t N>
+struct CacheKeyType<cache::SharedLFUCache<DataT, KeyT, N>> {
+    using type = KeyT;
+};
+#endif
+
 template <typename T> struct isCacheType : std::false_type {};
 
 template <typename DataT, typename KeyT>
@@ -24,6 +68,30 @@ struct isCacheType<cache::LFUCache<DataT, KeyT>> : std::true_type {};
 template <typename DataT, typename KeyT>
 struct isCacheType<cache::BeladyCache<DataT, KeyT>> : std::true_type {};
 
+template <typename DataT, typename KeyT>
+struct isCacheType<cache::OnlineBeladyCache<DataT, KeyT>> : std::true_type {};
+
+template <typename DataT, typename KeyT>
+struct isCacheType<cache::ARCCache<DataT, KeyT>> : std::true_type {};
+
+template <typename DataT, typename KeyT>
+struct isCacheType<cache::S3FIFOCache<DataT, KeyT>> : std::true_type {};
+
+template <typename DataT, typename KeyT, size_t N>
+struct isCacheType<cache::StaticLFUCache<DataT, KeyT, N>> : std::true_type {};
+
+template <typename DataT, typename KeyT, size_t Ways>
+struct isCacheType<cache::SetAssocLFUCache<DataT, KeyT, Ways>>
+    : std::true_type {};
+
+template <typename DataT, typename KeyT>
+struct isCacheType<cache::TieredCache<DataT, KeyT>> : std::true_type {};
+
+#ifdef CACHE_HAS_SHARED_MEMORY
+template <typename DataT, typename KeyT, size_t N>
+struct isCacheType<cache::SharedLFUCache<DataT, KeyT, N>> : std::true_type {};
+#endif
+
 template <typename T>
 concept CacheType = isCacheType<T>::value;
 
@@ -0,0 +1,189 @@
+#ifndef FILE_TIER_HPP
+#define FILE_TIER_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "IndexTable.hpp"
+
+namespace cache {
+
+// Fixed-size value slots in a scratch file. Slot i lives at offset
+// i * sizeof(T); keys, the index and the eviction state stay in memory, so
+// every get or put costs one seek plus one read or write. When all slots
+// are taken, the entry demoted longest ago is overwritten: slots are linked
+// in put order, and take() unlinks them. Entries leave on their first hit,
+// so reference bits would never be set and plain FIFO is all CLOCK would
+// give.
+template <typename T, typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+    requires std::is_trivially_copyable_v<T> &&
+             std::is_default_constructible_v<T>
+class FileTier {
+    using IndexT = uint32_t;
+    static constexpr IndexT NIL = IndexTable<KeyT>::NIL;
+
+    std::string path_;
+    std::fstream file_;
+
+    std::vector<KeyT> slotKeys_;
+    std::vector<IndexT> freeSlots_;
+    IndexTable<KeyT, Hash, Eq> index_;
+
+    // Used slots from oldest_ to newest_ in put order.
+    std::vector<IndexT> prev_;
+    std::vector<IndexT> next_;
+    IndexT oldest_ = NIL;
+    IndexT newest_ = NIL;
+
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+  private:
+    auto keyOf() const {
+        return [this](IndexT slot) -> const KeyT & { return slotKeys_[slot]; };
+    }
+
+    std::streamoff offsetOf(IndexT slot) const {
+        return static_cast<std::streamoff>(slot) * sizeof(T);
+    }
+
+    void linkNewest(IndexT slot) {
+        prev_[slot] = newest_;
+        next_[slot] = NIL;
+
+        if (newest_ != NIL)
+            next_[newest_] = slot;
+        else
+            oldest_ = slot;
+        newest_ = slot;
+    }
+
+    void unlinkSlot(IndexT slot) {
+        if (prev_[slot] != NIL)
+            next_[prev_[slot]] = next_[slot];
+        else
+            oldest_ = next_[slot];
+
+        if (next_[slot] != NIL)
+            prev_[next_[slot]] = prev_[slot];
+        else
+            newest_ = prev_[slot];
+    }
+
+    void releaseSlot(IndexT slot) {
+        index_.erase(slotKeys_[slot], keyOf());
+        unlinkSlot(slot);
+        size_--;
+    }
+
+    IndexT allocSlot() {
+        if (!freeSlots_.empty()) {
+            IndexT slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            return slot;
+        }
+
+        IndexT slot = oldest_;
+        releaseSlot(slot);
+        return slot;
+    }
+
+  public:
+    // The file at path is truncated and removed again in the destructor.
+    FileTier(const std::string &path, const size_t capacity)
+        : path_(path), file_(path, std::ios::binary | std::ios::in |
+                                       std::ios::out | std::ios::trunc),
+          slotKeys_(capacity), index_(capacity), prev_(capacity, NIL),
+          next_(capacity, NIL), capacity_(file_.is_open() ? capacity : 0) {
+        assert(capacity < NIL);
+
+        freeSlots_.reserve(capacity_);
+        for (size_t slot = capacity_; slot > 0; --slot)
+            freeSlots_.push_back(static_cast<IndexT>(slot - 1));
+    }
+
+    FileTier(const FileTier &) = delete;
+    FileTier &operator=(const FileTier &) = delete;
+
+    ~FileTier() {
+        if (file_.is_open()) {
+            file_.close();
+            std::error_code error;
+            std::filesystem::remove(path_, error);
+        }
+    }
+
+    bool contains(const KeyT &key) const {
+        return index_.find(key, keyOf()) != NIL;
+    }
+
+    // Stores data under key as the newest entry, possibly overwriting the
+    // oldest one. Returns false if the entry couldn't be written and was
+    // dropped.
+    bool put(const KeyT &key, const T &data) {
+        if (capacity_ == 0)
+            return false;
+
+        IndexT slot = index_.find(key, keyOf());
+        if (slot == NIL) {
+            slot = allocSlot();
+            slotKeys_[slot] = key;
+            index_.assign(key, slot, keyOf());
+            size_++;
+        } else {
+            unlinkSlot(slot);
+        }
+        linkNewest(slot);
+
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, std::addressof(data), sizeof(T));
+
+        file_.clear();
+        file_.seekp(offsetOf(slot));
+        file_.write(bytes, sizeof(T));
+        if (!file_) {
+            releaseSlot(slot);
+            freeSlots_.push_back(slot);
+            return false;
+        }
+        return true;
+    }
+
+    // Removes key from the tier and returns its data, if it was there.
+    std::optional<T> take(const KeyT &key) {
+        IndexT slot = index_.find(key, keyOf());
+        if (slot == NIL)
+            return std::nullopt;
+
+        char bytes[sizeof(T)];
+        file_.clear();
+        file_.seekg(offsetOf(slot));
+        file_.read(bytes, sizeof(T));
+        bool good = static_cast<bool>(file_);
+
+        releaseSlot(slot);
+        freeSlots_.push_back(slot);
+        if (!good)
+            return std::nullopt;
+
+        T data;
+        std::memcpy(std::addressof(data), bytes, sizeof(T));
+        return data;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+};
+
+} // namespace cache
+
+#endif // FILE_TIER_HPP
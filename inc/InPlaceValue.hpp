@@ -0,0 +1,28 @@
+#ifndef IN_PLACE_VALUE_HPP
+#define IN_PLACE_VALUE_HPP
+
+#include <concepts>
+
+namespace cache {
+
+// A cached value built straight from the loader's result: the constructor
+// calls loadData() in the member initializer, so thanks to guaranteed copy
+// elision the value is never copied or moved on the way into the cache, and
+// move-only and non-movable types work.
+//
+// This is what lets getOrLoad hand out a T& into the cache. The reference
+// stays valid until the next call that may evict. When a cache has nowhere
+// to keep a value (zero capacity, a Belady bypass), getOrLoad builds it in a
+// one-slot std::optional<InPlaceValue<T>> bypass_, so the reference still
+// lives until the next call. lookupUpdate doesn't load there at all.
+template <typename T> struct InPlaceValue {
+    T data_;
+
+    template <typename F>
+        requires std::invocable<F &>
+    constexpr explicit InPlaceValue(F &&loadData) : data_(loadData()) {}
+};
+
+} // namespace cache
+
+#endif // IN_PLACE_VALUE_HPP
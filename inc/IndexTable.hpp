@@ -0,0 +1,166 @@
+#ifndef INDEX_TABLE_HPP
+#define INDEX_TABLE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// Open addressing hash table of 32-bit entry ids with linear probing and
+// backward shift deletion. Keys aren't stored: every call gets keyOf, which
+// maps an id back to its key in the owner's arrays, so a cell costs 4 bytes.
+//
+// grow() never rehashes everything at once: the old cells stay readable and
+// migrate() moves a few of them per call into the new ones. Growing again
+// mid-migration chains another old table instead of finishing the first,
+// so until the chain drains a miss probes every table in it.
+template <typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+class IndexTable {
+  public:
+    using IndexT = uint32_t;
+    static constexpr IndexT NIL = std::numeric_limits<IndexT>::max();
+
+  private:
+    // Marks erased and migrated cells of old tables: shifting cells back
+    // there could move them behind migratePos_.
+    static constexpr IndexT TOMBSTONE = NIL - 1;
+
+    // Cells replaced by grow(), until migrated.
+    struct OldTable {
+        std::vector<IndexT> cells_;
+        size_t migratePos_ = 0;
+    };
+
+    std::vector<IndexT> cells_;
+    std::vector<OldTable> oldTables_; // oldest first
+
+    static size_t homePos(const std::vector<IndexT> &cells, const KeyT &key) {
+        uint64_t hash = Hash{}(key) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(((hash >> 32) * cells.size()) >> 32);
+    }
+
+    static size_t nextPos(const std::vector<IndexT> &cells, size_t pos) {
+        return pos + 1 == cells.size() ? 0 : pos + 1;
+    }
+
+    // Cyclic number of steps from pos `from` forward to pos `to`.
+    size_t probeDistance(size_t from, size_t to) const {
+        return to >= from ? to - from : to + cells_.size() - from;
+    }
+
+    // Position of key, or of the empty cell where it belongs.
+    template <typename KeyOf>
+    static size_t findPos(const std::vector<IndexT> &cells, const KeyT &key,
+                          const KeyOf &keyOf) {
+        size_t pos = homePos(cells, key);
+        while (cells[pos] != NIL &&
+               (cells[pos] == TOMBSTONE || !Eq{}(keyOf(cells[pos]), key)))
+            pos = nextPos(cells, pos);
+        return pos;
+    }
+
+    // Drops key from the old tables, if it is still there.
+    template <typename KeyOf>
+    void eraseOld(const KeyT &key, const KeyOf &keyOf) {
+        for (OldTable &old : oldTables_) {
+            size_t pos = findPos(old.cells_, key, keyOf);
+            if (old.cells_[pos] != NIL) {
+                old.cells_[pos] = TOMBSTONE;
+                return;
+            }
+        }
+    }
+
+  public:
+    // Load factor stays at most 3/4 while no more than maxSize ids are in.
+    explicit IndexTable(size_t maxSize = 0)
+        : cells_(maxSize + maxSize / 3 + 1, NIL) {}
+
+    template <typename KeyOf>
+    IndexT find(const KeyT &key, const KeyOf &keyOf) const {
+        IndexT id = cells_[findPos(cells_, key, keyOf)];
+        for (size_t i = 0; id == NIL && i < oldTables_.size(); ++i) {
+            const std::vector<IndexT> &old = oldTables_[i].cells_;
+            id = old[findPos(old, key, keyOf)];
+        }
+        return id;
+    }
+
+    // Maps key to id, keyOf(id) must already be equal to key.
+    template <typename KeyOf>
+    void assign(const KeyT &key, IndexT id, const KeyOf &keyOf) {
+        assert(Eq{}(keyOf(id), key));
+        assert(id < TOMBSTONE);
+
+        eraseOld(key, keyOf);
+        cells_[findPos(cells_, key, keyOf)] = id;
+    }
+
+    template <typename KeyOf> void erase(const KeyT &key, const KeyOf &keyOf) {
+        size_t hole = findPos(cells_, key, keyOf);
+        if (cells_[hole] == NIL) {
+            assert(migrating());
+            eraseOld(key, keyOf);
+            return;
+        }
+        cells_[hole] = NIL;
+
+        for (size_t pos = nextPos(cells_, hole); cells_[pos] != NIL;
+             pos = nextPos(cells_, pos)) {
+            size_t home = homePos(cells_, keyOf(cells_[pos]));
+            if (probeDistance(home, pos) < probeDistance(hole, pos))
+                continue;
+
+            cells_[hole] = cells_[pos];
+            cells_[pos] = NIL;
+            hole = pos;
+        }
+    }
+
+    // Makes room for maxSize ids. Ids move to the new cells in later
+    // migrate() calls. Costs O(maxSize) for the new cells, but no id moves.
+    void grow(size_t maxSize) {
+        oldTables_.push_back({std::move(cells_), 0});
+        cells_.assign(maxSize + maxSize / 3 + 1, NIL);
+    }
+
+    bool migrating() const { return !oldTables_.empty(); }
+
+    // Moves up to `count` old cells into the new table, oldest table first.
+    template <typename KeyOf> void migrate(size_t count, const KeyOf &keyOf) {
+        while (count != 0 && migrating()) {
+            OldTable &old = oldTables_.front();
+            size_t end = std::min(old.cells_.size(), old.migratePos_ + count);
+            count -= end - old.migratePos_;
+
+            for (; old.migratePos_ < end; ++old.migratePos_) {
+                IndexT &id = old.cells_[old.migratePos_];
+                if (id != NIL && id != TOMBSTONE) {
+                    cells_[findPos(cells_, keyOf(id), keyOf)] = id;
+                    id = TOMBSTONE;
+                }
+            }
+
+            if (old.migratePos_ == old.cells_.size())
+                oldTables_.erase(oldTables_.begin());
+        }
+    }
+
+    size_t memoryUsage() const {
+        size_t cells = cells_.capacity();
+        for (const OldTable &old : oldTables_)
+            cells += old.cells_.capacity();
+        return cells * sizeof(IndexT) +
+               oldTables_.capacity() * sizeof(OldTable);
+    }
+};
+
+} // namespace cache
+
+#endif // INDEX_TABLE_HPP
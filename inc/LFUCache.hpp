@@ -1,139 +1,518 @@
 #ifndef LFUCACHE_HPP
 #define LFUCACHE_HPP
 
+#include <algorithm>
 #include <cassert>
-#include <list>
-#include <map>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "InPlaceValue.hpp"
+#include "IndexTable.hpp"
+#include "Snapshot.hpp"
 
 namespace cache {
 
-template <typename T, typename KeyT> struct LFUCacheNode {
-    using FreqT = size_t;
-
-    KeyT key_;
-    T data_;
-    FreqT freq_;
-};
-
-template <typename T, typename KeyT>
-std::ostream &operator<<(std::ostream &stream,
-                         const LFUCacheNode<T, KeyT> &cacheNode) {
-    stream << cacheNode.key_;
-    return stream;
-}
-
-template <typename T, typename KeyT>
-std::ostream &operator<<(std::ostream &stream,
-                         const std::list<LFUCacheNode<T, KeyT>> &freqList) {
-    for (auto to : freqList) {
-        stream << to << " ";
-    }
-    return stream;
-}
-
 template <typename T, typename KeyT, typename Hash = std::hash<KeyT>,
           typename Eq = std::equal_to<KeyT>>
 class LFUCache {
-    using CacheListIt =
-        typename std::list<LFUCacheNode<T, const KeyT *>>::iterator;
-    using FreqT = typename LFUCacheNode<T, const KeyT *>::FreqT;
-
-    std::unordered_set<KeyT, Hash, Eq> keyStorage_;
-
-    std::unordered_map<const KeyT *, CacheListIt> hashTable_;
-    std::map<FreqT, std::list<LFUCacheNode<T, const KeyT *>>> freqTable_;
+    using IndexT = uint32_t;
+    using FreqT = uint32_t;
+
+    static constexpr IndexT NIL = IndexTable<KeyT>::NIL;
+    static constexpr FreqT MAX_FREQ = std::numeric_limits<FreqT>::max();
+
+    // Per-call work left over from resize(): evictions after shrinking and
+    // index cells moved after growing.
+    static constexpr size_t EVICT_BATCH = 8;
+    static constexpr size_t MIGRATE_BATCH = 16;
+
+    // Values go into snapshots as raw bytes.
+    static constexpr bool SNAPSHOT_VALUES =
+        std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>;
+
+    // Structure of arrays: entry i is keys_[i], freqs_[i], prev_[i],
+    // next_[i] and values_[i]. values_ is a deque so that it never
+    // relocates values and works for non-movable types.
+    std::vector<KeyT> keys_;
+    std::vector<FreqT> freqs_;
+    std::vector<IndexT> prev_;
+    std::vector<IndexT> next_;
+    std::deque<std::optional<InPlaceValue<T>>> values_;
+    std::vector<IndexT> freeNodes_; // freed by shrinking or failed loads
+
+    // All residents form one list ordered by frequency, and from oldest to
+    // newest within a frequency, so head_ is always the eviction victim.
+    // freqTable_ maps every present frequency to the newest entry with it.
+    IndexT head_ = NIL;
+    IndexTable<KeyT, Hash, Eq> hashTable_;
+    IndexTable<FreqT> freqTable_;
+
+    std::optional<InPlaceValue<T>> bypass_; // zero capacity
+
+    // Gets every evicted entry before it is destroyed.
+    std::function<void(const KeyT &, T &&)> evictHandler_;
 
     FreqT minFreq_ = 0;
     size_t size_ = 0;
     size_t capacity_ = 0;
+    size_t indexCapacity_ = 0; // ids the index tables are sized for
 
   private:
-    const KeyT *getKeyPtr(const KeyT &key) {
-        auto [it, _] = keyStorage_.insert(key);
-        return std::addressof(*it);
+    bool full() const { return (size_ >= capacity_); }
+
+    auto keyOf() const {
+        return [this](IndexT node) -> const KeyT & { return keys_[node]; };
     }
 
-    bool full() const { return (size_ == capacity_); }
+    auto freqOf() const {
+        return [this](IndexT node) { return freqs_[node]; };
+    }
+
+    void recomputeMinFreq() { minFreq_ = head_ == NIL ? 0 : freqs_[head_]; }
+
+    // Links node right after `after`, or at the head if `after` is NIL.
+    void linkAfter(IndexT node, IndexT after) {
+        IndexT next = after == NIL ? head_ : next_[after];
+
+        prev_[node] = after;
+        next_[node] = next;
+
+        if (next != NIL)
+            prev_[next] = node;
+        if (after != NIL)
+            next_[after] = node;
+        else
+            head_ = node;
+    }
+
+    void unlinkNode(IndexT node) {
+        if (prev_[node] != NIL)
+            next_[prev_[node]] = next_[node];
+        else
+            head_ = next_[node];
+
+        if (next_[node] != NIL)
+            prev_[next_[node]] = prev_[node];
+    }
 
-    void recomputeMinFreq() {
-        if (freqTable_.empty()) {
-            minFreq_ = 0;
+    void refreshNode(IndexT node) {
+        FreqT freq = freqs_[node];
+        if (freq == MAX_FREQ)
             return;
+
+        IndexT freqTail = freqTable_.find(freq, freqOf());
+        IndexT nextFreqTail = freqTable_.find(freq + 1, freqOf());
+        assert(freqTail != NIL);
+
+        bool wasTail = freqTail == node;
+        if (wasTail) {
+            IndexT prev = prev_[node];
+            if (prev != NIL && freqs_[prev] == freq)
+                freqTable_.assign(freq, prev, freqOf());
+            else
+                freqTable_.erase(freq, freqOf());
+        }
+
+        // The newest entry of freq + 1 goes right after the current newest
+        // one, or right after the run of freq if there is none yet.
+        if (nextFreqTail != NIL) {
+            unlinkNode(node);
+            linkAfter(node, nextFreqTail);
+        } else if (!wasTail) {
+            unlinkNode(node);
+            linkAfter(node, freqTail);
         }
-        minFreq_ = freqTable_.begin()->first;
+
+        freqs_[node] = freq + 1;
+        freqTable_.assign(freq + 1, node, freqOf());
+        recomputeMinFreq();
     }
 
-    void refreshKey(const KeyT *key) {
-        assert(hashTable_.contains(key));
+    // Evicts the least frequently used entry and returns its id for reuse.
+    IndexT removeLFUNode() {
+        assert(head_ != NIL);
 
-        CacheListIt cacheListIt = hashTable_[key];
-        FreqT oldFreq = cacheListIt->freq_++;
+        IndexT node = head_;
+        if (freqTable_.find(freqs_[node], freqOf()) == node)
+            freqTable_.erase(freqs_[node], freqOf());
+        hashTable_.erase(keys_[node], keyOf());
 
-        assert(freqTable_.contains(oldFreq));
-        assert(!freqTable_[oldFreq].empty());
-        assert(cacheListIt->freq_ != oldFreq);
+        unlinkNode(node);
+        if (evictHandler_ && values_[node].has_value())
+            evictHandler_(keys_[node], std::move(values_[node]->data_));
+        values_[node].reset();
+        size_--;
+        recomputeMinFreq();
 
-        freqTable_[cacheListIt->freq_].splice(
-            freqTable_[cacheListIt->freq_].end(), freqTable_[oldFreq],
-            cacheListIt);
-        if (freqTable_[oldFreq].empty() && oldFreq == minFreq_) {
-            freqTable_.erase(oldFreq);
-            recomputeMinFreq();
+        return node;
+    }
+
+    IndexT allocNode(const KeyT &key) {
+        if (full())
+            return removeLFUNode();
+
+        if (!freeNodes_.empty()) {
+            IndexT node = freeNodes_.back();
+            freeNodes_.pop_back();
+            return node;
         }
+
+        keys_.push_back(key);
+        freqs_.push_back(0);
+        prev_.push_back(NIL);
+        next_.push_back(NIL);
+        values_.emplace_back();
+
+        return static_cast<IndexT>(keys_.size() - 1);
     }
 
-    void removeLFUNode() {
-        assert(freqTable_.contains(minFreq_));
+    // Returns the resident value for key and whether it was a hit. With
+    // zero capacity the value is only loaded if needValue, else it's null.
+    template <typename F>
+    std::pair<T *, bool> access(const KeyT &key, F &slowGetPage,
+                                bool needValue) {
+        auto loadData = [&] { return slowGetPage(key); };
+
+        for (size_t i = 0; i < EVICT_BATCH && size_ > capacity_; ++i)
+            freeNodes_.push_back(removeLFUNode());
+        hashTable_.migrate(MIGRATE_BATCH, keyOf());
+        freqTable_.migrate(MIGRATE_BATCH, freqOf());
+
+        if (capacity_ == 0) {
+            if (!needValue)
+                return {nullptr, false};
+            bypass_.emplace(loadData);
+            return {std::addressof(bypass_->data_), false};
+        }
 
-        CacheListIt LFUIt = freqTable_[minFreq_].begin();
+        IndexT node = hashTable_.find(key, keyOf());
+        if (node != NIL) {
+            refreshNode(node);
+            if (values_[node].has_value())
+                return {std::addressof(values_[node]->data_), true};
 
-        hashTable_.erase(LFUIt->key_);
-        freqTable_[minFreq_].pop_front();
-        size_--;
+            // Restored from a snapshot without values: the frequency is
+            // known, the data still has to be fetched.
+            values_[node].emplace(loadData);
+            return {std::addressof(values_[node]->data_), false};
+        }
 
-        if (freqTable_[minFreq_].empty()) {
-            freqTable_.erase(minFreq_);
-            recomputeMinFreq();
+        // The entry is published only once its value is there: if loading
+        // throws, the node goes back to freeNodes_ unused.
+        node = allocNode(key);
+        try {
+            values_[node].emplace(loadData);
+        } catch (...) {
+            freeNodes_.push_back(node);
+            throw;
         }
+
+        keys_[node] = key;
+        freqs_[node] = 0;
+        hashTable_.assign(key, node, keyOf());
+
+        linkAfter(node, freqTable_.find(0, freqOf()));
+        freqTable_.assign(0, node, freqOf());
+        minFreq_ = 0;
+        size_++;
+
+        return {std::addressof(values_[node]->data_), false};
     }
 
   public:
-    LFUCache(const size_t capacity) : capacity_(capacity) {}
+    LFUCache(const size_t capacity)
+        : hashTable_(capacity), freqTable_(capacity), capacity_(capacity),
+          indexCapacity_(capacity) {
+        assert(capacity_ < NIL);
+
+        keys_.reserve(capacity_);
+        freqs_.reserve(capacity_);
+        prev_.reserve(capacity_);
+        next_.reserve(capacity_);
+    }
 
     template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
-        if (capacity_ == 0)
-            return false;
+        return access(key, slowGetPage, false).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> T &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage, true).first;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    // Changes the capacity without evicting or rehashing everything at
+    // once: extra entries are evicted EVICT_BATCH per call, and grown index
+    // tables move MIGRATE_BATCH cells per call, oldest first if resize runs
+    // again mid-migration. Growing is still O(capacity) in resize itself:
+    // the entry arrays are reserved, which copies them once, and the new
+    // tables are allocated. Doing that here keeps the copy out of a later
+    // push_back.
+    void resize(const size_t capacity) {
+        assert(capacity < NIL);
+
+        if (capacity > indexCapacity_) {
+            keys_.reserve(capacity);
+            freqs_.reserve(capacity);
+            prev_.reserve(capacity);
+            next_.reserve(capacity);
+
+            hashTable_.grow(capacity);
+            freqTable_.grow(capacity);
+            indexCapacity_ = capacity;
+        }
+        capacity_ = capacity;
+    }
+
+    bool contains(const KeyT &key) const {
+        return hashTable_.find(key, keyOf()) != NIL;
+    }
+
+    // handler(key, data) runs on every eviction, right before the entry is
+    // destroyed, and may take the data. It must not call back into the
+    // cache.
+    void setEvictHandler(std::function<void(const KeyT &, T &&)> handler) {
+        evictHandler_ = std::move(handler);
+    }
+
+    void clear() {
+        keys_.clear();
+        freqs_.clear();
+        prev_.clear();
+        next_.clear();
+        values_.clear();
+        freeNodes_.clear();
+
+        hashTable_ = IndexTable<KeyT, Hash, Eq>(capacity_);
+        freqTable_ = IndexTable<FreqT>(capacity_);
+        indexCapacity_ = capacity_;
+
+        head_ = NIL;
+        minFreq_ = 0;
+        size_ = 0;
+    }
+
+    // Writes keys, frequencies, minFreq_ and, if T is trivially copyable,
+    // values to path. The file is replaced atomically. Returns false on I/O
+    // errors, leaving no temporary file behind.
+    bool saveSnapshot(const std::string &path) const
+        requires std::is_trivially_copyable_v<KeyT>
+    {
+        bool withValues = SNAPSHOT_VALUES;
+        for (IndexT node = head_; node != NIL && withValues; node = next_[node])
+            withValues = values_[node].has_value();
+
+        size_t valueSize = withValues ? sizeof(T) : 0;
+        std::vector<char> payload(size_ *
+                                  (sizeof(KeyT) + sizeof(FreqT) + valueSize));
+        char *keysOut = payload.data();
+        char *freqsOut = keysOut + size_ * sizeof(KeyT);
+        char *valuesOut = freqsOut + size_ * sizeof(FreqT);
+
+        size_t i = 0;
+        for (IndexT node = head_; node != NIL; node = next_[node], ++i) {
+            std::memcpy(keysOut + i * sizeof(KeyT), &keys_[node],
+                        sizeof(KeyT));
+            std::memcpy(freqsOut + i * sizeof(FreqT), &freqs_[node],
+                        sizeof(FreqT));
+            if constexpr (SNAPSHOT_VALUES)
+                if (withValues)
+                    std::memcpy(valuesOut + i * sizeof(T),
+                                std::addressof(values_[node]->data_),
+                                sizeof(T));
+        }
+        assert(i == size_);
+
+        LFUSnapshotHeader header{};
+        std::memcpy(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_));
+        header.version_ = SNAPSHOT_VERSION;
+        header.flags_ = withValues ? SNAPSHOT_HAS_VALUES : 0;
+        header.keySize_ = sizeof(KeyT);
+        header.valueSize_ = static_cast<uint32_t>(valueSize);
+        header.capacity_ = capacity_;
+        header.size_ = size_;
+        header.minFreq_ = minFreq_;
+        header.checksum_ = snapshotChecksum(payload.data(), payload.size());
+
+        // The data reaches the disk before the rename, so a crash leaves
+        // either the old snapshot or the new one, never a torn file.
+        std::string tmpPath = path + ".tmp";
+        bool written = false;
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(payload.data(),
+                       static_cast<std::streamsize>(payload.size()));
+            file.close();
+            written = !file.fail();
+        }
+
+        std::error_code error;
+        if (written && syncFile(tmpPath)) {
+            std::filesystem::rename(tmpPath, path, error);
+            if (!error)
+                return true;
+        }
+        std::filesystem::remove(tmpPath, error);
+        return false;
+    }
 
-        const KeyT *keyPtr = getKeyPtr(key);
+    // Replaces the cache contents with the snapshot at path. The file is
+    // memory mapped, keys and frequencies are memcpy'd in bulk, and the
+    // list links and both indexes are rebuilt in one linear pass; the key
+    // index is filled while checking for duplicates, before anything is
+    // replaced. If the snapshot holds more than capacity_ entries, the least
+    // frequently used ones are dropped. Entries saved without values are
+    // loaded on their first access. On a missing, corrupt or foreign file
+    // returns false and leaves the cache untouched.
+    bool loadSnapshot(const std::string &path)
+        requires std::is_trivially_copyable_v<KeyT> &&
+                 std::is_default_constructible_v<KeyT>
+    {
+        MappedFile file;
+        if (!file.open(path) || file.size() < sizeof(LFUSnapshotHeader))
+            return false;
 
-        assert(hashTable_.size() <= capacity_);
-        assert(size_ <= capacity_);
+        LFUSnapshotHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
 
-        if (!hashTable_.contains(keyPtr)) {
-            if (full())
-                removeLFUNode();
+        bool withValues = header.flags_ & SNAPSHOT_HAS_VALUES;
+        if (std::memcmp(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_)) ||
+            header.version_ != SNAPSHOT_VERSION ||
+            (header.flags_ & ~SNAPSHOT_HAS_VALUES) ||
+            header.keySize_ != sizeof(KeyT) || header.size_ >= NIL)
+            return false;
+        if (withValues && (!SNAPSHOT_VALUES || header.valueSize_ != sizeof(T)))
+            return false;
 
-            freqTable_[0].push_back({keyPtr, slowGetPage(key), 0});
-            hashTable_[keyPtr] = std::prev(freqTable_[0].end());
-            minFreq_ = 0;
-            size_++;
+        size_t valueSize = withValues ? sizeof(T) : 0;
+        const char *payload = file.data() + sizeof(header);
+        size_t payloadSize = file.size() - sizeof(header);
+        if (header.size_ * (sizeof(KeyT) + sizeof(FreqT) + valueSize) !=
+                payloadSize ||
+            snapshotChecksum(payload, payloadSize) != header.checksum_)
+            return false;
 
+        size_t total = header.size_;
+        size_t count = std::min(total, capacity_);
+        size_t skip = total - count;
+        const char *keysIn = payload + skip * sizeof(KeyT);
+        const char *freqsIn =
+            payload + total * sizeof(KeyT) + skip * sizeof(FreqT);
+        const char *valuesIn =
+            payload + total * (sizeof(KeyT) + sizeof(FreqT)) + skip * valueSize;
+
+        // A valid checksum only proves the file is intact. Everything that
+        // would break the invariants is checked before the cache is touched:
+        // frequencies must not decrease along the list, and keys must be
+        // unique. The index built for the check is kept, its ids are the
+        // positions keys_ gets below.
+        auto fileFreq = [freqsIn](size_t i) {
+            FreqT freq;
+            std::memcpy(&freq, freqsIn + i * sizeof(FreqT), sizeof(FreqT));
+            return freq;
+        };
+        auto fileKeyOf = [keysIn](IndexT id) {
+            KeyT key;
+            std::memcpy(&key, keysIn + id * sizeof(KeyT), sizeof(KeyT));
+            return key;
+        };
+
+        if (count != 0 && skip == 0 && fileFreq(0) != header.minFreq_)
             return false;
+
+        IndexTable<KeyT, Hash, Eq> index(capacity_);
+        for (size_t i = 0; i < count; ++i) {
+            if (i + 1 < count && fileFreq(i) > fileFreq(i + 1))
+                return false;
+
+            KeyT key = fileKeyOf(static_cast<IndexT>(i));
+            if (index.find(key, fileKeyOf) != NIL)
+                return false;
+            index.assign(key, static_cast<IndexT>(i), fileKeyOf);
         }
 
-        refreshKey(keyPtr);
+        clear();
+        hashTable_ = std::move(index);
+
+        keys_.resize(count);
+        freqs_.resize(count);
+        std::memcpy(keys_.data(), keysIn, count * sizeof(KeyT));
+        std::memcpy(freqs_.data(), freqsIn, count * sizeof(FreqT));
+
+        // File order is list order, so the links are implicit.
+        prev_.resize(count);
+        next_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            prev_[i] = i == 0 ? NIL : static_cast<IndexT>(i - 1);
+            next_[i] = i + 1 == count ? NIL : static_cast<IndexT>(i + 1);
+        }
+        head_ = count == 0 ? NIL : 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            IndexT node = static_cast<IndexT>(i);
+            if (i + 1 == count || freqs_[i + 1] != freqs_[i])
+                freqTable_.assign(freqs_[i], node, freqOf());
+
+            if constexpr (SNAPSHOT_VALUES) {
+                if (withValues) {
+                    values_.emplace_back(std::in_place, [&] {
+                        T value;
+                        std::memcpy(&value, valuesIn + i * sizeof(T),
+                                    sizeof(T));
+                        return value;
+                    });
+                    continue;
+                }
+            }
+            values_.emplace_back();
+        }
+
+        size_ = count;
+        recomputeMinFreq();
 
         return true;
     }
 
+    // Bytes held by the cache, including keys and values.
+    size_t memoryUsage() const {
+        size_t bytes = sizeof(*this);
+
+        bytes += keys_.capacity() * sizeof(KeyT);
+        bytes += freqs_.capacity() * sizeof(FreqT);
+        bytes += (prev_.capacity() + next_.capacity()) * sizeof(IndexT);
+        bytes += freeNodes_.capacity() * sizeof(IndexT);
+        bytes += values_.size() * sizeof(std::optional<InPlaceValue<T>>);
+        bytes += hashTable_.memoryUsage() + freqTable_.memoryUsage();
+
+        return bytes;
+    }
+
     void print() const {
         std::cout << "LFU CACHE:\n";
         std::cout << "cap     : " << capacity_ << '\n';
         std::cout << "minFreq : " << minFreq_ << '\n';
         std::cout << "FREQ TABLE : \n";
 
-        for (auto &[key, val] : freqTable_) {
-            std::cout << key << " : " << val << '\n';
+        for (IndexT node = head_; node != NIL; node = next_[node]) {
+            if (node == head_ || freqs_[prev_[node]] != freqs_[node])
+                std::cout << freqs_[node] << " : ";
+            std::cout << keys_[node] << " ";
+            if (next_[node] == NIL || freqs_[next_[node]] != freqs_[node])
+                std::cout << '\n';
         }
         std::cout << '\n';
     }
@@ -0,0 +1,239 @@
+#ifndef ONLINE_BELADY_CACHE_HPP
+#define ONLINE_BELADY_CACHE_HPP
+
+#include <cassert>
+#include <concepts>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+#include "InPlaceValue.hpp"
+
+namespace cache {
+
+template <typename DataT>
+struct OnlineBeladyCacheNode : InPlaceValue<DataT> {
+    size_t freq_ = 1;
+    size_t lastUse_ = 0;
+
+    template <typename F>
+        requires std::invocable<F &>
+    explicit OnlineBeladyCacheNode(F &&loadData)
+        : InPlaceValue<DataT>(loadData) {}
+};
+
+// BeladyCache for streams: it only sees the next `window` requests, pulled
+// from the source as the stream is consumed. Residents used again inside
+// the window are ranked by their next use, like in BeladyCache. The rest
+// are ranked after them by frequency and then by last use, like in
+// LFUCache. Memory is O(window + capacity).
+template <typename DataT, typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+class OnlineBeladyCache {
+    static constexpr size_t NO_NEXT_USE = std::numeric_limits<size_t>::max();
+
+    // Residents ordered from the first to evict to the last one.
+    struct Rank {
+        size_t nextUse_;
+        size_t freq_;
+        size_t lastUse_;
+        KeyT key_;
+
+        bool operator<(const Rank &other) const {
+            if (nextUse_ != other.nextUse_)
+                return nextUse_ > other.nextUse_;
+            if (freq_ != other.freq_)
+                return freq_ < other.freq_;
+            return lastUse_ < other.lastUse_;
+        }
+    };
+
+    std::function<std::optional<KeyT>()> source_;
+    size_t window_ = 0;
+    size_t capacity_ = 0;
+
+    // The current request followed by up to window_ upcoming ones.
+    // lookahead_.front() is request number position_ of the stream, and
+    // nextUses_ holds the positions of every key inside lookahead_.
+    std::deque<KeyT> lookahead_;
+    size_t position_ = 0;
+    std::unordered_map<KeyT, std::deque<size_t>, Hash, Eq> nextUses_;
+
+    std::unordered_map<KeyT, OnlineBeladyCacheNode<DataT>, Hash, Eq> cache_;
+    std::set<Rank> ranks_;
+    size_t clock_ = 0;
+
+    // Zero capacity, or the key is requested later than every resident.
+    std::optional<InPlaceValue<DataT>> bypass_;
+
+  private:
+    bool full() const { return cache_.size() == capacity_; }
+
+    size_t nextUse(const KeyT &key) const {
+        auto it = nextUses_.find(key);
+        return it == nextUses_.end() ? NO_NEXT_USE : it->second.front();
+    }
+
+    Rank rankOf(const KeyT &key,
+                const OnlineBeladyCacheNode<DataT> &node) const {
+        return {nextUse(key), node.freq_, node.lastUse_, key};
+    }
+
+    // Applies update to key's state, keeping its rank in ranks_ in sync if
+    // key is resident.
+    template <typename F> void updateKey(const KeyT &key, F update) {
+        auto it = cache_.find(key);
+        if (it == cache_.end()) {
+            update();
+            return;
+        }
+
+        ranks_.erase(rankOf(key, it->second));
+        update();
+        ranks_.insert(rankOf(key, it->second));
+    }
+
+    void fillLookahead() {
+        while (lookahead_.size() <= window_) {
+            std::optional<KeyT> key = source_();
+            if (!key.has_value())
+                return;
+
+            size_t pos = position_ + lookahead_.size();
+            lookahead_.push_back(*key);
+
+            auto it = nextUses_.find(*key);
+            if (it != nextUses_.end())
+                it->second.push_back(pos); // next use stays the same
+            else
+                updateKey(*key, [&] { nextUses_[*key].push_back(pos); });
+        }
+    }
+
+    // Moves the window past the current request.
+    void consume(const KeyT &key) {
+        bool expected = !lookahead_.empty() && Eq{}(lookahead_.front(), key);
+        assert(expected && "request doesn't match the stream");
+        if (!expected)
+            return;
+
+        auto it = nextUses_.find(key);
+        assert(it != nextUses_.end() && it->second.front() == position_);
+        it->second.pop_front();
+        if (it->second.empty())
+            nextUses_.erase(it);
+
+        lookahead_.pop_front();
+        position_++;
+    }
+
+    // Returns the value for key (resident or bypassed) and whether it was a
+    // hit. A bypassed value is only loaded if needValue, else it's null.
+    template <typename F>
+    std::pair<DataT *, bool> access(const KeyT &key, F &slowGetPage,
+                                    bool needValue) {
+        auto loadData = [&] { return slowGetPage(key); };
+
+        fillLookahead();
+        clock_++;
+
+        auto hashIt = cache_.find(key);
+        if (hashIt != cache_.end()) {
+            OnlineBeladyCacheNode<DataT> &node = hashIt->second;
+            updateKey(key, [&] {
+                consume(key);
+                node.freq_++;
+                node.lastUse_ = clock_;
+            });
+            return {std::addressof(node.data_), true};
+        }
+
+        consume(key);
+
+        if (capacity_ == 0) {
+            if (!needValue)
+                return {nullptr, false};
+            bypass_.emplace(loadData);
+            return {std::addressof(bypass_->data_), false};
+        }
+
+        if (full()) {
+            // Beyond the window nothing is known, so a key that isn't seen
+            // in it still replaces a resident that isn't either.
+            auto victim = ranks_.begin();
+            if (victim->nextUse_ < nextUse(key)) {
+                if (!needValue)
+                    return {nullptr, false};
+                bypass_.emplace(loadData);
+                return {std::addressof(bypass_->data_), false};
+            }
+
+            cache_.erase(victim->key_);
+            ranks_.erase(victim);
+        }
+
+        auto [it, _] = cache_.try_emplace(key, loadData);
+        it->second.lastUse_ = clock_;
+        ranks_.insert(rankOf(key, it->second));
+
+        return {std::addressof(it->second.data_), false};
+    }
+
+  public:
+    // source returns the next request of the stream, or std::nullopt at its
+    // end. Requests must then arrive in the same order.
+    OnlineBeladyCache(const size_t capacity, const size_t window,
+                      std::function<std::optional<KeyT>()> source)
+        : source_(std::move(source)), window_(window), capacity_(capacity) {}
+
+    // Reads the stream from [beginIt, endIt), which may be a single pass
+    // range such as std::istream_iterator.
+    template <typename IterT>
+        requires std::same_as<typename std::iterator_traits<IterT>::value_type,
+                              KeyT>
+    OnlineBeladyCache(const size_t capacity, const size_t window,
+                      IterT beginIt, const IterT endIt)
+        : OnlineBeladyCache(
+              capacity, window,
+              [beginIt, endIt]() mutable -> std::optional<KeyT> {
+                  if (beginIt == endIt)
+                      return std::nullopt;
+                  return *beginIt++;
+              }) {}
+
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage, false).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> DataT &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage, true).first;
+    }
+
+    size_t size() const { return cache_.size(); }
+
+    void print() const {
+        std::cout << "ONLINE BELADY CACHE:\n";
+        std::cout << "cap    : " << capacity_ << '\n';
+        std::cout << "window : " << window_ << '\n';
+        std::cout << "cache (eviction order) : ";
+        for (const Rank &rank : ranks_) {
+            std::cout << rank.key_ << "(";
+            if (rank.nextUse_ == NO_NEXT_USE)
+                std::cout << "freq " << rank.freq_;
+            else
+                std::cout << "next " << rank.nextUse_;
+            std::cout << ") ";
+        }
+        std::cout << "\n\n";
+    }
+};
+
+} // namespace cache
+
+#endif // ONLINE_BELADY_CACHE_HPP
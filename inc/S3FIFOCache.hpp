@@ -0,0 +1,203 @@
+#ifndef S3FIFO_CACHE_HPP
+#define S3FIFO_CACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "StripedSharedMutex.hpp"
+
+namespace cache {
+
+// S3-FIFO: a small probationary FIFO, a main FIFO and a ghost FIFO of
+// recently evicted keys. A hit never reorders anything - it only bumps a
+// saturating per-entry atomic counter, so hits run under a shared lock,
+// striped so that they scale with cores. All queue movement happens at
+// eviction time under the exclusive lock.
+// slowGetPage runs with no lock held, so a slow miss never stalls hits.
+template <typename T, typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+class S3FIFOCache {
+    using FreqT = uint8_t;
+    static constexpr FreqT MAX_FREQ = 3;
+
+    struct S3FIFOCacheEntry {
+        T data_;
+        std::atomic<FreqT> freq_ = 0;
+
+        explicit S3FIFOCacheEntry(T &&data) : data_(std::move(data)) {}
+    };
+
+    using Table = std::unordered_map<KeyT, S3FIFOCacheEntry, Hash, Eq>;
+    using Node = typename Table::value_type;
+    using GhostList = std::list<KeyT>;
+
+    // Queues hold pointers to hash table nodes: they stay valid on rehash.
+    Table hashTable_;
+    std::deque<Node *> small_;
+    std::deque<Node *> main_;
+
+    GhostList ghost_;
+    std::unordered_map<KeyT, typename GhostList::iterator, Hash, Eq>
+        ghostTable_;
+
+    size_t capacity_ = 0;
+    size_t smallCapacity_ = 0;
+    size_t ghostCapacity_ = 0;
+
+    mutable StripedSharedMutex mutex_;
+
+  private:
+    static void refreshEntry(S3FIFOCacheEntry &entry) {
+        FreqT freq = entry.freq_.load(std::memory_order_relaxed);
+        while (freq < MAX_FREQ &&
+               !entry.freq_.compare_exchange_weak(freq, freq + 1,
+                                                  std::memory_order_relaxed))
+            ;
+    }
+
+    void pushGhost(const KeyT &key) {
+        if (ghostTable_.contains(key))
+            return;
+
+        if (ghost_.size() == ghostCapacity_) {
+            ghostTable_.erase(ghost_.front());
+            ghost_.pop_front();
+        }
+        ghost_.push_back(key);
+        ghostTable_[key] = std::prev(ghost_.end());
+    }
+
+    bool popGhost(const KeyT &key) {
+        auto ghostIt = ghostTable_.find(key);
+        if (ghostIt == ghostTable_.end())
+            return false;
+
+        ghost_.erase(ghostIt->second);
+        ghostTable_.erase(ghostIt);
+        return true;
+    }
+
+    // One step of small-queue eviction: the head either gets promoted into
+    // main_ (it was hit while on probation) or leaves the cache via ghost_.
+    void evictSmallStep() {
+        assert(!small_.empty());
+
+        Node *node = small_.front();
+        small_.pop_front();
+
+        if (node->second.freq_.load(std::memory_order_relaxed) > 0) {
+            main_.push_back(node);
+            return;
+        }
+
+        pushGhost(node->first);
+        hashTable_.erase(node->first);
+    }
+
+    // One step of main-queue eviction: CLOCK-like second chance, paid for
+    // with one unit of frequency per reinsertion.
+    void evictMainStep() {
+        assert(!main_.empty());
+
+        Node *node = main_.front();
+        main_.pop_front();
+
+        FreqT freq = node->second.freq_.load(std::memory_order_relaxed);
+        if (freq > 0) {
+            node->second.freq_.store(freq - 1, std::memory_order_relaxed);
+            main_.push_back(node);
+            return;
+        }
+
+        hashTable_.erase(node->first);
+    }
+
+    void makeRoom() {
+        while (hashTable_.size() >= capacity_) {
+            if (!small_.empty() &&
+                (small_.size() >= smallCapacity_ || main_.empty()))
+                evictSmallStep();
+            else
+                evictMainStep();
+        }
+    }
+
+    void insert(const KeyT &key, T &&data) {
+        makeRoom();
+
+        auto [it, inserted] = hashTable_.try_emplace(key, std::move(data));
+        assert(inserted);
+
+        if (popGhost(key))
+            main_.push_back(std::addressof(*it));
+        else
+            small_.push_back(std::addressof(*it));
+    }
+
+  public:
+    S3FIFOCache(const size_t capacity)
+        : capacity_(capacity),
+          smallCapacity_(std::max<size_t>(capacity / 10, 1)),
+          ghostCapacity_(std::max<size_t>(capacity - smallCapacity_, 1)) {}
+
+    // Safe to call concurrently from several threads.
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        if (capacity_ == 0)
+            return false;
+
+        {
+            std::shared_lock lock(mutex_);
+            auto it = hashTable_.find(key);
+            if (it != hashTable_.end()) {
+                refreshEntry(it->second);
+                return true;
+            }
+        }
+
+        T data = slowGetPage(key);
+
+        std::unique_lock lock(mutex_);
+        assert(hashTable_.size() == small_.size() + main_.size());
+
+        // Another thread may have loaded the key meanwhile: keep its copy.
+        auto it = hashTable_.find(key);
+        if (it != hashTable_.end()) {
+            refreshEntry(it->second);
+            return false;
+        }
+
+        insert(key, std::move(data));
+        return false;
+    }
+
+    void print() const {
+        std::shared_lock lock(mutex_);
+
+        std::cout << "S3FIFO CACHE:\n";
+        std::cout << "cap : " << capacity_ << '\n';
+
+        std::cout << "S : ";
+        for (Node *node : small_)
+            std::cout << node->first << " ";
+        std::cout << "\nM : ";
+        for (Node *node : main_)
+            std::cout << node->first << " ";
+        std::cout << "\nG : ";
+        for (auto &key : ghost_)
+            std::cout << key << " ";
+        std::cout << "\n\n";
+    }
+};
+
+} // namespace cache
+
+#endif // S3FIFO_CACHE_HPP
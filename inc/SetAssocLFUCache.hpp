@@ -0,0 +1,215 @@
+#ifndef SET_ASSOC_LFU_CACHE_HPP
+#define SET_ASSOC_LFU_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "InPlaceValue.hpp"
+#include "StaticLFUCache.hpp"
+
+namespace cache {
+
+template <typename T, typename KeyT>
+struct SetAssocLFUCacheNode : InPlaceValue<T> {
+    KeyT key_;
+
+    template <typename F>
+        requires std::invocable<F &>
+    SetAssocLFUCacheNode(const KeyT &key, F &&loadData)
+        : InPlaceValue<T>(loadData), key_(key) {}
+};
+
+// Approximate LFU: a key may only live in one of Ways slots of the set its
+// hash points to, and eviction picks the lowest frequency within that set.
+// The tags and frequencies of a set share one cache line, so a lookup
+// touches one line of metadata plus the matching node.
+template <typename T, typename KeyT, size_t Ways = 8,
+          typename Hash = StaticHash<KeyT>, typename Eq = std::equal_to<KeyT>>
+class SetAssocLFUCache {
+    static_assert(Ways == 8 || Ways == 16,
+                  "SetAssocLFUCache supports 8- and 16-way sets");
+
+    using TagT = uint16_t;
+    using FreqT = uint8_t;
+    using MaskT = uint32_t; // bit i set - way i matches
+
+    static constexpr TagT EMPTY_TAG = 0;
+    static constexpr FreqT MAX_FREQ = 15;
+
+    struct alignas(64) CacheSet {
+        std::array<TagT, Ways> tags_{};
+        std::array<FreqT, Ways> freqs_{};
+    };
+    static_assert(sizeof(CacheSet) == 64);
+
+    std::vector<CacheSet> sets_;
+    std::vector<std::optional<SetAssocLFUCacheNode<T, KeyT>>> nodes_;
+
+    std::optional<InPlaceValue<T>> bypass_; // zero capacity
+
+    size_t capacity_ = 0;
+    MaskT waysMask_ = 0; // ways usable in every set
+
+  private:
+    static MaskT matchTags(const CacheSet &cacheSet, TagT tag) {
+#if defined(__SSE2__)
+        const __m128i *tags =
+            reinterpret_cast<const __m128i *>(cacheSet.tags_.data());
+        __m128i low;
+        __m128i high = _mm_setzero_si128();
+
+#if defined(__AVX2__)
+        if constexpr (Ways == 16) {
+            __m256i eq = _mm256_cmpeq_epi16(
+                _mm256_load_si256(reinterpret_cast<const __m256i *>(tags)),
+                _mm256_set1_epi16(static_cast<short>(tag)));
+            low = _mm256_castsi256_si128(eq);
+            high = _mm256_extracti128_si256(eq, 1);
+        } else
+#endif
+        {
+            __m128i needle = _mm_set1_epi16(static_cast<short>(tag));
+            low = _mm_cmpeq_epi16(_mm_load_si128(tags), needle);
+            if constexpr (Ways == 16)
+                high = _mm_cmpeq_epi16(_mm_load_si128(tags + 1), needle);
+        }
+
+        // Narrow 16-bit lanes to bytes: one mask bit per way.
+        return static_cast<MaskT>(
+            _mm_movemask_epi8(_mm_packs_epi16(low, high)));
+#else
+        MaskT mask = 0;
+        for (size_t way = 0; way < Ways; ++way)
+            mask |= static_cast<MaskT>(cacheSet.tags_[way] == tag) << way;
+        return mask;
+#endif
+    }
+
+    size_t setIndex(size_t hash) const {
+        uint64_t low = static_cast<uint32_t>(hash);
+        return static_cast<size_t>((low * sets_.size()) >> 32);
+    }
+
+    static TagT tagOf(size_t hash) {
+        TagT tag = static_cast<TagT>(static_cast<uint64_t>(hash) >> 48);
+        return tag == EMPTY_TAG ? 1 : tag;
+    }
+
+    static void refreshWay(CacheSet &cacheSet, size_t way) {
+        // Halving the whole set on saturation keeps old favourites from
+        // pinning it forever.
+        if (cacheSet.freqs_[way] == MAX_FREQ)
+            for (FreqT &freq : cacheSet.freqs_)
+                freq /= 2;
+        cacheSet.freqs_[way]++;
+    }
+
+    size_t getLFUWay(const CacheSet &cacheSet) const {
+        size_t lfuWay = 0;
+        for (size_t way = 1; way < Ways; ++way)
+            if ((waysMask_ >> way & 1) &&
+                cacheSet.freqs_[way] < cacheSet.freqs_[lfuWay])
+                lfuWay = way;
+        return lfuWay;
+    }
+
+    // Returns the resident value for key and whether it was a hit. With
+    // zero capacity the value is only loaded if needValue, else it's null.
+    template <typename F>
+    std::pair<T *, bool> access(const KeyT &key, F &slowGetPage,
+                                bool needValue) {
+        auto loadData = [&] { return slowGetPage(key); };
+
+        if (capacity_ == 0) {
+            if (!needValue)
+                return {nullptr, false};
+            bypass_.emplace(loadData);
+            return {std::addressof(bypass_->data_), false};
+        }
+
+        size_t hash = Hash{}(key);
+        size_t set = setIndex(hash);
+        TagT tag = tagOf(hash);
+        CacheSet &cacheSet = sets_[set];
+
+        for (MaskT matches = matchTags(cacheSet, tag) & waysMask_; matches;
+             matches &= matches - 1) {
+            size_t way = std::countr_zero(matches);
+            auto &node = nodes_[set * Ways + way];
+            assert(node.has_value());
+
+            if (Eq{}(node->key_, key)) {
+                refreshWay(cacheSet, way);
+                return {std::addressof(node->data_), true};
+            }
+        }
+
+        MaskT empty = matchTags(cacheSet, EMPTY_TAG) & waysMask_;
+        size_t way = empty ? std::countr_zero(empty) : getLFUWay(cacheSet);
+
+        // Emptied first: if loading throws, the way is left free.
+        auto &node = nodes_[set * Ways + way];
+        cacheSet.tags_[way] = EMPTY_TAG;
+        node.emplace(key, loadData);
+        cacheSet.tags_[way] = tag;
+        cacheSet.freqs_[way] = 0;
+
+        return {std::addressof(node->data_), false};
+    }
+
+  public:
+    // Holds at most capacity entries: capacity / Ways full sets, or a single
+    // narrower set when capacity < Ways.
+    SetAssocLFUCache(const size_t capacity) : capacity_(capacity) {
+        if (capacity_ == 0)
+            return;
+
+        size_t ways = std::min(capacity_, Ways);
+        waysMask_ = static_cast<MaskT>((uint64_t{1} << ways) - 1);
+
+        sets_.resize(std::max<size_t>(capacity_ / Ways, 1));
+        nodes_.resize(sets_.size() * Ways);
+    }
+
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage, false).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> T &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage, true).first;
+    }
+
+    void print() const {
+        std::cout << "SET ASSOC LFU CACHE:\n";
+        std::cout << "cap  : " << capacity_ << '\n';
+        std::cout << "sets : " << sets_.size() << " x " << Ways << '\n';
+
+        for (size_t set = 0; set < sets_.size(); ++set) {
+            std::cout << set << " : ";
+            for (size_t way = 0; way < Ways; ++way) {
+                const auto &node = nodes_[set * Ways + way];
+                if (node.has_value())
+                    std::cout << node->key_ << "("
+                              << int(sets_[set].freqs_[way]) << ") ";
+            }
+            std::cout << '\n';
+        }
+        std::cout << '\n';
+    }
+};
+
+} // namespace cache
+
+#endif // SET_ASSOC_LFU_CACHE_HPP
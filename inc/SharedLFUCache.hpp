@@ -0,0 +1,338 @@
+#ifndef SHARED_LFU_CACHE_HPP
+#define SHARED_LFU_CACHE_HPP
+
+#if defined(__unix__)
+#define CACHE_HAS_SHARED_MEMORY 1
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "StaticLFUCache.hpp"
+
+namespace cache {
+
+inline constexpr uint64_t SHARED_LFU_MAGIC = 0x3144524853554c46ULL;
+
+// Identifies the segment layout: the sizes and alignments involved plus
+// the full template argument list, spelled out by __PRETTY_FUNCTION__, so
+// <float, int, N> and <int, int, N> don't match despite equal sizes.
+template <typename T, typename KeyT, typename CacheT, typename SegmentT>
+constexpr uint64_t sharedLFULayout() {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 0x100000001b3ULL;
+    };
+
+    for (const char *c = __PRETTY_FUNCTION__; *c != 0; ++c)
+        mix(static_cast<unsigned char>(*c));
+    for (size_t value : {sizeof(T), alignof(T), sizeof(KeyT), alignof(KeyT),
+                         sizeof(CacheT), alignof(CacheT), sizeof(SegmentT)})
+        mix(value);
+    return hash;
+}
+
+// The whole shared memory object. StaticLFUCache links entries by indices
+// and keeps everything inline, so it works at any mapping address.
+template <typename CacheT> struct SharedLFUSegment {
+    // Written last by the creator, read through atomic_ref by the others.
+    alignas(std::atomic_ref<uint64_t>::required_alignment) uint64_t magic_;
+    // Written first by the creator, so the others can tell if it died.
+    alignas(std::atomic_ref<uint64_t>::required_alignment) uint64_t creator_;
+    uint64_t segmentSize_;
+    uint64_t layout_;
+    uint64_t recoveries_; // times a dead lock owner forced a reset
+    pthread_mutex_t mutex_;
+    CacheT cache_;
+};
+
+// StaticLFUCache shared by all processes that open the same POSIX shared
+// memory name. One robust process-shared mutex guards it; if a process dies
+// holding it, the next one to lock resets the cache. A segment whose
+// creator died before finishing it is removed and created anew. Loading
+// runs outside the lock.
+template <typename T, typename KeyT, size_t N,
+          typename Hash = StaticHash<KeyT>, typename Eq = std::equal_to<KeyT>>
+    requires std::is_trivially_copyable_v<T> &&
+             std::is_trivially_copyable_v<KeyT>
+class SharedLFUCache {
+    using CacheT = StaticLFUCache<T, KeyT, N, Hash, Eq>;
+    using Segment = SharedLFUSegment<CacheT>;
+
+    static constexpr uint64_t LAYOUT =
+        sharedLFULayout<T, KeyT, CacheT, Segment>();
+    static constexpr auto ATTACH_TIMEOUT = std::chrono::seconds(2);
+    static constexpr int OPEN_ATTEMPTS = 3;
+
+    enum class OpenResult { ATTACHED, FAILED, STALE };
+
+    Segment *segment_ = nullptr;
+
+  private:
+    std::atomic_ref<uint64_t> magic() const {
+        return std::atomic_ref<uint64_t>(segment_->magic_);
+    }
+
+    std::atomic_ref<uint64_t> creator() const {
+        return std::atomic_ref<uint64_t>(segment_->creator_);
+    }
+
+    bool published() const {
+        return magic().load(std::memory_order_acquire) == SHARED_LFU_MAGIC;
+    }
+
+    // False once the creator is known to be gone; 0 means it hasn't
+    // written its pid yet.
+    bool creatorAlive() const {
+        uint64_t pid = creator().load(std::memory_order_relaxed);
+        return pid == 0 || kill(static_cast<pid_t>(pid), 0) == 0 ||
+               errno != ESRCH;
+    }
+
+    void lock() {
+        int error = pthread_mutex_lock(&segment_->mutex_);
+        if (error == EOWNERDEAD) {
+            // The owner died mid-update and may have left the links broken.
+            std::destroy_at(&segment_->cache_);
+            ::new (&segment_->cache_) CacheT;
+            segment_->recoveries_++;
+            pthread_mutex_consistent(&segment_->mutex_);
+        } else {
+            assert(error == 0);
+        }
+    }
+
+    void unlock() { pthread_mutex_unlock(&segment_->mutex_); }
+
+    template <typename Pred> static bool waitFor(Pred ready) {
+        auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+        while (!ready()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    bool initSegment() {
+        ::new (segment_) Segment;
+        creator().store(static_cast<uint64_t>(getpid()),
+                        std::memory_order_relaxed);
+        segment_->segmentSize_ = sizeof(Segment);
+        segment_->layout_ = LAYOUT;
+        segment_->recoveries_ = 0;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int error = pthread_mutex_init(&segment_->mutex_, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (error != 0)
+            return false;
+
+        magic().store(SHARED_LFU_MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    bool map(int fd) {
+        void *addr = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+            return false;
+
+        segment_ = static_cast<Segment *>(addr);
+        return true;
+    }
+
+    OpenResult create(const std::string &name, int fd) {
+        if (ftruncate(fd, sizeof(Segment)) != 0) {
+            close(fd);
+        } else if (map(fd)) {
+            if (initSegment())
+                return OpenResult::ATTACHED;
+            detach();
+        }
+
+        shm_unlink(name.c_str());
+        return OpenResult::FAILED;
+    }
+
+    OpenResult attach(const std::string &name, int fd) {
+        // A fresh object is empty until its creator sizes it.
+        struct stat st {};
+        bool sized = waitFor([&] {
+            return fstat(fd, &st) == 0 && st.st_size != 0;
+        });
+        if (!sized) {
+            close(fd);
+            return removeStale(name, st);
+        }
+        if (static_cast<size_t>(st.st_size) != sizeof(Segment)) {
+            close(fd);
+            return OpenResult::FAILED;
+        }
+        if (!map(fd))
+            return OpenResult::FAILED;
+
+        waitFor([this] { return published() || !creatorAlive(); });
+        if (!published()) {
+            // No pid after the whole timeout: it died before writing it.
+            bool alive = creator().load(std::memory_order_relaxed) != 0 &&
+                         creatorAlive();
+            detach();
+            return alive ? OpenResult::FAILED : removeStale(name, st);
+        }
+
+        if (segment_->segmentSize_ != sizeof(Segment) ||
+            segment_->layout_ != LAYOUT) {
+            detach();
+            return OpenResult::FAILED;
+        }
+        return OpenResult::ATTACHED;
+    }
+
+    // Unlinks name unless it already refers to another object than the
+    // stale one described by st, e.g. one recreated by another process.
+    static OpenResult removeStale(const std::string &name,
+                                  const struct stat &st) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+            return OpenResult::STALE;
+
+        struct stat current {};
+        bool same = fstat(fd, &current) == 0 && current.st_dev == st.st_dev &&
+                    current.st_ino == st.st_ino;
+        close(fd);
+        if (same)
+            shm_unlink(name.c_str());
+        return OpenResult::STALE;
+    }
+
+    // Returns a copy of the value for key and whether it was a hit.
+    template <typename F>
+    std::pair<T, bool> access(const KeyT &key, F &slowGetPage) {
+        std::optional<T> cached = withLock([&](CacheT &cache) {
+            return cache.contains(key)
+                       ? std::optional<T>(cache.getOrLoad(key, slowGetPage))
+                       : std::nullopt;
+        });
+        if (cached.has_value())
+            return {*cached, true};
+
+        // If another process inserts key meanwhile, this just bumps its
+        // frequency.
+        T data = slowGetPage(key);
+        withLock([&](CacheT &cache) {
+            cache.lookupUpdate(key, [&](const KeyT &) { return data; });
+        });
+        return {data, false};
+    }
+
+  public:
+    SharedLFUCache() = default;
+    SharedLFUCache(const SharedLFUCache &) = delete;
+    SharedLFUCache &operator=(const SharedLFUCache &) = delete;
+
+    ~SharedLFUCache() { detach(); }
+
+    // Attaches to the segment called name (e.g. "/lfu"), creating it if it
+    // doesn't exist yet. Fails if the segment was created for another
+    // T, KeyT, N, Hash or Eq, or if its creator is alive but doesn't finish
+    // in ATTACH_TIMEOUT. If the creator died first, the segment is stale:
+    // it is unlinked and created again. A creator that died before sizing
+    // the segment can't be identified, so that case costs the full timeout.
+    bool open(const std::string &name) {
+        assert(segment_ == nullptr);
+
+        for (int attempt = 0; attempt < OPEN_ATTEMPTS; ++attempt) {
+            int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            bool creator = fd >= 0;
+            if (!creator && errno == EEXIST)
+                fd = shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0) {
+                if (errno == ENOENT) // unlinked as stale meanwhile
+                    continue;
+                return false;
+            }
+
+            OpenResult result = creator ? create(name, fd) : attach(name, fd);
+            if (result != OpenResult::STALE)
+                return result == OpenResult::ATTACHED;
+        }
+        return false;
+    }
+
+    // Unmaps the segment, which stays alive for the other processes.
+    void detach() {
+        if (segment_ != nullptr)
+            munmap(segment_, sizeof(Segment));
+        segment_ = nullptr;
+    }
+
+    // Removes the name; attached processes keep their mappings.
+    static bool unlink(const std::string &name) {
+        return shm_unlink(name.c_str()) == 0;
+    }
+
+    // Runs f on the shared StaticLFUCache while holding the lock.
+    template <typename F> decltype(auto) withLock(F &&f) {
+        assert(segment_ != nullptr);
+
+        struct Unlock {
+            SharedLFUCache *owner_;
+            ~Unlock() { owner_->unlock(); }
+        };
+
+        lock();
+        Unlock unlock{this};
+        return f(segment_->cache_);
+    }
+
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage).second;
+    }
+
+    // Returns a copy of the value: the entry may be evicted by another
+    // process as soon as the lock is released.
+    template <typename F> T getOrLoad(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage).first;
+    }
+
+    size_t size() {
+        return withLock([](CacheT &cache) { return cache.size(); });
+    }
+
+    size_t recoveries() {
+        return withLock([this](CacheT &) { return segment_->recoveries_; });
+    }
+
+    static constexpr size_t memoryUsage() { return sizeof(Segment); }
+
+    void print() {
+        withLock([](CacheT &cache) { cache.print(); });
+    }
+};
+
+} // namespace cache
+
+#endif // __unix__
+
+#endif // SHARED_LFU_CACHE_HPP
@@ -0,0 +1,129 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cache {
+
+inline constexpr char SNAPSHOT_MAGIC[8] = {'L', 'F', 'U', 'S',
+                                           'N', 'A', 'P', 0};
+inline constexpr uint32_t SNAPSHOT_VERSION = 1;
+inline constexpr uint32_t SNAPSHOT_HAS_VALUES = 1;
+
+// Snapshot file: this header, then size_ keys, size_ frequencies and, with
+// SNAPSHOT_HAS_VALUES, size_ values. Entries go in eviction order, so the
+// file order is the list order. Integers are in host byte order.
+struct LFUSnapshotHeader {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t flags_;
+    uint32_t keySize_;
+    uint32_t valueSize_;
+    uint64_t capacity_;
+    uint64_t size_;
+    uint32_t minFreq_;
+    uint32_t reserved_;
+    uint64_t checksum_; // of everything after the header
+};
+static_assert(sizeof(LFUSnapshotHeader) == 56);
+static_assert(std::is_trivially_copyable_v<LFUSnapshotHeader>);
+
+// FNV-1a, 64 bit.
+inline uint64_t snapshotChecksum(const char *data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Flushes the file at path to the disk. A no-op where fsync is missing.
+inline bool syncFile(const std::string &path) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+        return false;
+
+    bool synced = fsync(fd) == 0;
+    return close(fd) == 0 && synced;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+// Read-only view of a whole file: mmap where available, plain read
+// elsewhere.
+class MappedFile {
+#if defined(__unix__) || defined(__APPLE__)
+    void *data_ = MAP_FAILED;
+    size_t size_ = 0;
+#else
+    std::vector<char> data_;
+#endif
+
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+#if defined(__unix__) || defined(__APPLE__)
+    ~MappedFile() {
+        if (data_ != MAP_FAILED)
+            munmap(data_, size_);
+    }
+
+    bool open(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+
+        size_ = static_cast<size_t>(st.st_size);
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        return data_ != MAP_FAILED;
+    }
+
+    const char *data() const { return static_cast<const char *>(data_); }
+    size_t size() const { return size_; }
+#else
+    bool open(const std::string &path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+
+        data_.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return !data_.empty() &&
+               file.read(data_.data(), static_cast<std::streamsize>(
+                                           data_.size()));
+    }
+
+    const char *data() const { return data_.data(); }
+    size_t size() const { return data_.size(); }
+#endif
+};
+
+} // namespace cache
+
+#endif // SNAPSHOT_HPP
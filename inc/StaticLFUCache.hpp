@@ -0,0 +1,304 @@
+#ifndef STATIC_LFU_CACHE_HPP
+#define STATIC_LFU_CACHE_HPP
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include "InPlaceValue.hpp"
+
+namespace cache {
+
+// std::hash isn't constexpr, and for integers it's the identity, which is
+// a poor fit for a power-of-two open addressing table.
+template <typename KeyT> struct StaticHash {
+    constexpr size_t operator()(const KeyT &key) const {
+        if constexpr (std::is_integral_v<KeyT>) {
+            uint64_t x = static_cast<uint64_t>(key);
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return static_cast<size_t>(x);
+        } else {
+            return std::hash<KeyT>{}(key);
+        }
+    }
+};
+
+// LFU cache with capacity N fixed at compile time. All storage lives in
+// std::arrays inside the object and entries are linked by 16- or 32-bit
+// indices, so nothing touches the heap. Eviction order matches LFUCache:
+// lowest frequency first, oldest within the same frequency.
+template <typename T, typename KeyT, size_t N,
+          typename Hash = StaticHash<KeyT>, typename Eq = std::equal_to<KeyT>>
+class StaticLFUCache {
+    static_assert(N > 0, "StaticLFUCache capacity must be positive");
+    static_assert(N < std::numeric_limits<uint32_t>::max(),
+                  "StaticLFUCache capacity doesn't fit 32-bit indices");
+
+    using IndexT =
+        std::conditional_t<(N < std::numeric_limits<uint16_t>::max()),
+                           uint16_t, uint32_t>;
+    using FreqT = size_t;
+
+    static constexpr IndexT NIL = std::numeric_limits<IndexT>::max();
+    static constexpr size_t TABLE_SIZE = std::bit_ceil(2 * N);
+    static constexpr size_t TABLE_MASK = TABLE_SIZE - 1;
+
+    // One resident entry, linked into the list of its frequency bucket.
+    struct StaticLFUCacheNode {
+        KeyT key_{};
+        IndexT prev_ = NIL;
+        IndexT next_ = NIL;
+        IndexT bucket_ = NIL;
+    };
+
+    // All residents with the same frequency, oldest at head_. Buckets are
+    // linked in increasing frequency order; free ones form a list by next_.
+    struct FreqBucket {
+        FreqT freq_ = 0;
+        IndexT head_ = NIL;
+        IndexT tail_ = NIL;
+        IndexT prev_ = NIL;
+        IndexT next_ = NIL;
+    };
+
+    std::array<StaticLFUCacheNode, N> nodes_{};
+    std::array<std::optional<InPlaceValue<T>>, N> data_{};
+    std::array<FreqBucket, N> buckets_{};
+    std::array<IndexT, TABLE_SIZE> hashTable_{}; // open addressing, node ids
+
+    IndexT minBucket_ = NIL; // bucket with the lowest frequency
+    IndexT freeBucket_ = NIL;
+    IndexT spareNode_ = NIL; // freed by a miss whose load threw
+    size_t size_ = 0;
+
+  private:
+    constexpr size_t homePos(const KeyT &key) const {
+        return Hash{}(key) & TABLE_MASK;
+    }
+
+    // Position of key in hashTable_, or of the empty cell where it belongs.
+    constexpr size_t findPos(const KeyT &key) const {
+        size_t pos = homePos(key);
+        while (hashTable_[pos] != NIL &&
+               !Eq{}(nodes_[hashTable_[pos]].key_, key))
+            pos = (pos + 1) & TABLE_MASK;
+        return pos;
+    }
+
+    // Backward shift deletion: keeps probe chains intact without tombstones.
+    constexpr void erasePos(size_t pos) {
+        hashTable_[pos] = NIL;
+
+        for (size_t next = (pos + 1) & TABLE_MASK; hashTable_[next] != NIL;
+             next = (next + 1) & TABLE_MASK) {
+            size_t home = homePos(nodes_[hashTable_[next]].key_);
+            bool stays = (next > pos) ? (home > pos && home <= next)
+                                      : (home > pos || home <= next);
+            if (stays)
+                continue;
+
+            hashTable_[pos] = hashTable_[next];
+            hashTable_[next] = NIL;
+            pos = next;
+        }
+    }
+
+    constexpr IndexT allocBucket(FreqT freq, IndexT prev, IndexT next) {
+        assert(freeBucket_ != NIL);
+
+        IndexT bucket = freeBucket_;
+        freeBucket_ = buckets_[bucket].next_;
+        buckets_[bucket] = {freq, NIL, NIL, prev, next};
+
+        if (prev != NIL)
+            buckets_[prev].next_ = bucket;
+        else
+            minBucket_ = bucket;
+        if (next != NIL)
+            buckets_[next].prev_ = bucket;
+
+        return bucket;
+    }
+
+    constexpr void freeBucket(IndexT bucket) {
+        FreqBucket &freqBucket = buckets_[bucket];
+        assert(freqBucket.head_ == NIL);
+
+        if (freqBucket.prev_ != NIL)
+            buckets_[freqBucket.prev_].next_ = freqBucket.next_;
+        else
+            minBucket_ = freqBucket.next_;
+        if (freqBucket.next_ != NIL)
+            buckets_[freqBucket.next_].prev_ = freqBucket.prev_;
+
+        freqBucket.next_ = freeBucket_;
+        freeBucket_ = bucket;
+    }
+
+    constexpr void appendNode(IndexT node, IndexT bucket) {
+        StaticLFUCacheNode &cacheNode = nodes_[node];
+        FreqBucket &freqBucket = buckets_[bucket];
+
+        cacheNode.bucket_ = bucket;
+        cacheNode.prev_ = freqBucket.tail_;
+        cacheNode.next_ = NIL;
+
+        if (freqBucket.tail_ != NIL)
+            nodes_[freqBucket.tail_].next_ = node;
+        else
+            freqBucket.head_ = node;
+        freqBucket.tail_ = node;
+    }
+
+    // Detaches node from its bucket, freeing the bucket if it runs empty.
+    constexpr void unlinkNode(IndexT node) {
+        StaticLFUCacheNode &cacheNode = nodes_[node];
+        IndexT bucket = cacheNode.bucket_;
+        FreqBucket &freqBucket = buckets_[bucket];
+
+        if (cacheNode.prev_ != NIL)
+            nodes_[cacheNode.prev_].next_ = cacheNode.next_;
+        else
+            freqBucket.head_ = cacheNode.next_;
+        if (cacheNode.next_ != NIL)
+            nodes_[cacheNode.next_].prev_ = cacheNode.prev_;
+        else
+            freqBucket.tail_ = cacheNode.prev_;
+
+        if (freqBucket.head_ == NIL)
+            freeBucket(bucket);
+    }
+
+    constexpr void refreshNode(IndexT node) {
+        IndexT bucket = nodes_[node].bucket_;
+        FreqT newFreq = buckets_[bucket].freq_ + 1;
+        IndexT nextBucket = buckets_[bucket].next_;
+        bool alone = buckets_[bucket].head_ == buckets_[bucket].tail_;
+
+        if (nextBucket != NIL && buckets_[nextBucket].freq_ == newFreq) {
+            unlinkNode(node);
+            appendNode(node, nextBucket);
+            return;
+        }
+
+        // The bucket would die anyway, bumping it in place keeps the order.
+        if (alone) {
+            buckets_[bucket].freq_ = newFreq;
+            return;
+        }
+
+        IndexT newBucket = allocBucket(newFreq, bucket, nextBucket);
+        unlinkNode(node);
+        appendNode(node, newBucket);
+    }
+
+    // Evicts the least frequently used node and returns its id for reuse.
+    constexpr IndexT removeLFUNode() {
+        assert(minBucket_ != NIL);
+
+        IndexT node = buckets_[minBucket_].head_;
+        erasePos(findPos(nodes_[node].key_));
+        unlinkNode(node);
+        data_[node].reset();
+        size_--;
+
+        return node;
+    }
+
+    template <typename F>
+    constexpr std::pair<T *, bool> access(const KeyT &key, F &slowGetPage) {
+        assert(size_ <= N);
+
+        size_t pos = findPos(key);
+        if (hashTable_[pos] != NIL) {
+            IndexT node = hashTable_[pos];
+            refreshNode(node);
+            return {std::addressof(data_[node]->data_), true};
+        }
+
+        IndexT node =
+            spareNode_ != NIL ? spareNode_ : static_cast<IndexT>(size_);
+        if (size_ == N) {
+            node = removeLFUNode();
+            pos = findPos(key); // eviction may have shifted the chain
+        }
+
+        // The node is published only once the value is there: if loading
+        // throws, it stays unused and the next miss takes it.
+        spareNode_ = node;
+        data_[node].emplace([&] { return slowGetPage(key); });
+        spareNode_ = NIL;
+
+        nodes_[node].key_ = key;
+        hashTable_[pos] = node;
+
+        IndexT bucket = minBucket_;
+        if (bucket == NIL || buckets_[bucket].freq_ != 0)
+            bucket = allocBucket(0, NIL, minBucket_);
+        appendNode(node, bucket);
+        size_++;
+
+        return {std::addressof(data_[node]->data_), false};
+    }
+
+  public:
+    constexpr StaticLFUCache() {
+        hashTable_.fill(NIL);
+
+        for (size_t i = 0; i + 1 < N; ++i)
+            buckets_[i].next_ = static_cast<IndexT>(i + 1);
+        freeBucket_ = 0;
+    }
+
+    static constexpr size_t capacity() { return N; }
+    constexpr size_t size() const { return size_; }
+
+    constexpr bool contains(const KeyT &key) const {
+        return hashTable_[findPos(key)] != NIL;
+    }
+
+    // Everything lives inside the object.
+    static constexpr size_t memoryUsage() { return sizeof(StaticLFUCache); }
+
+    template <typename F>
+    constexpr bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F>
+    constexpr T &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage).first;
+    }
+
+    void print() const {
+        std::cout << "STATIC LFU CACHE:\n";
+        std::cout << "cap     : " << N << '\n';
+        std::cout << "FREQ TABLE : \n";
+
+        for (IndexT bucket = minBucket_; bucket != NIL;
+             bucket = buckets_[bucket].next_) {
+            std::cout << buckets_[bucket].freq_ << " : ";
+            for (IndexT node = buckets_[bucket].head_; node != NIL;
+                 node = nodes_[node].next_)
+                std::cout << nodes_[node].key_ << " ";
+            std::cout << '\n';
+        }
+        std::cout << '\n';
+    }
+};
+
+} // namespace cache
+
+#endif // STATIC_LFU_CACHE_HPP
@@ -0,0 +1,79 @@
+#ifndef STRIPED_SHARED_MUTEX_HPP
+#define STRIPED_SHARED_MUTEX_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace cache {
+
+// Reader-writer lock for read-mostly data. std::shared_mutex makes every
+// reader write one shared lock word, so readers on different cores keep
+// stealing its cache line from each other and shared locking stops scaling
+// after a couple of threads. Here a reader only bumps the counter of its
+// own stripe, on its own cache line, and reads writing_, which stays in
+// every core's cache until a writer comes. A writer raises writing_, which
+// turns new readers back, and waits for the stripes to drain: a handful of
+// loads instead of one lock per stripe. Writers win over readers. Meets
+// SharedMutex, so std::shared_lock and std::unique_lock work with it.
+class StripedSharedMutex {
+    static constexpr size_t STRIPES = 16;
+
+    struct alignas(64) Stripe {
+        std::atomic<size_t> readers_ = 0;
+    };
+
+    std::array<Stripe, STRIPES> stripes_;
+    alignas(64) std::atomic<bool> writing_ = false;
+    std::mutex writerMutex_;
+
+  private:
+    // Threads get stripes round robin on first use and keep them, so
+    // unlock_shared() finds the stripe lock_shared() took.
+    static size_t threadStripe() {
+        static std::atomic<size_t> nextStripe = 0;
+        thread_local size_t stripe =
+            nextStripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripe;
+    }
+
+  public:
+    // writing_ and readers_ are sequentially consistent on both sides: a
+    // reader and a writer racing for the lock always see each other.
+    void lock() {
+        writerMutex_.lock();
+        writing_.store(true);
+        for (Stripe &stripe : stripes_)
+            while (stripe.readers_.load() != 0)
+                std::this_thread::yield();
+    }
+
+    void unlock() {
+        writing_.store(false);
+        writing_.notify_all();
+        writerMutex_.unlock();
+    }
+
+    void lock_shared() {
+        std::atomic<size_t> &readers = stripes_[threadStripe()].readers_;
+        while (true) {
+            readers.fetch_add(1);
+            if (!writing_.load())
+                return;
+
+            readers.fetch_sub(1);
+            writing_.wait(true);
+        }
+    }
+
+    void unlock_shared() {
+        stripes_[threadStripe()].readers_.fetch_sub(
+            1, std::memory_order_release);
+    }
+};
+
+} // namespace cache
+
+#endif // STRIPED_SHARED_MUTEX_HPP
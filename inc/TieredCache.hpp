@@ -0,0 +1,98 @@
+#ifndef TIERED_CACHE_HPP
+#define TIERED_CACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include "FileTier.hpp"
+#include "LFUCache.hpp"
+
+namespace cache {
+
+struct TieredCacheStats {
+    size_t memoryHits_ = 0;
+    size_t diskHits_ = 0;
+    size_t misses_ = 0;
+    size_t demotions_ = 0;
+};
+
+// LFUCache in front of a FileTier. The tiers are exclusive: entries evicted
+// from memory are demoted to the file, and a disk hit moves the entry back
+// into memory, so slowGetPage only runs when both tiers miss.
+template <typename T, typename KeyT, typename Hash = std::hash<KeyT>,
+          typename Eq = std::equal_to<KeyT>>
+class TieredCache {
+    LFUCache<T, KeyT, Hash, Eq> memory_;
+    FileTier<T, KeyT, Hash, Eq> disk_;
+    TieredCacheStats stats_;
+
+  private:
+    // Returns the resident value for key and whether it was a hit in either
+    // tier.
+    template <typename F>
+    std::pair<T *, bool> access(const KeyT &key, F &slowGetPage) {
+        if (memory_.contains(key)) {
+            stats_.memoryHits_++;
+            return {std::addressof(memory_.getOrLoad(key, slowGetPage)), true};
+        }
+
+        // Taken out before the promotion, which may demote another entry
+        // and must not push this one out of the file.
+        if (std::optional<T> spilled = disk_.take(key)) {
+            stats_.diskHits_++;
+            T &data = memory_.getOrLoad(key, [&](const KeyT &) -> T {
+                return *spilled;
+            });
+            return {std::addressof(data), true};
+        }
+
+        stats_.misses_++;
+        return {std::addressof(memory_.getOrLoad(key, slowGetPage)), false};
+    }
+
+  public:
+    // The disk tier lives in a scratch file at path.
+    TieredCache(const size_t memoryCapacity, const size_t diskCapacity,
+                const std::string &path)
+        : memory_(memoryCapacity), disk_(path, diskCapacity) {
+        memory_.setEvictHandler([this](const KeyT &key, T &&data) {
+            if (disk_.put(key, data))
+                stats_.demotions_++;
+        });
+    }
+
+    // The eviction handler points back at this object.
+    TieredCache(const TieredCache &) = delete;
+    TieredCache &operator=(const TieredCache &) = delete;
+
+    template <typename F> bool lookupUpdate(const KeyT &key, F slowGetPage) {
+        return access(key, slowGetPage).second;
+    }
+
+    // lookupUpdate returning the value; see InPlaceValue for its lifetime.
+    template <typename F> T &getOrLoad(const KeyT &key, F slowGetPage) {
+        return *access(key, slowGetPage).first;
+    }
+
+    size_t size() const { return memory_.size() + disk_.size(); }
+    const TieredCacheStats &stats() const { return stats_; }
+
+    void print() const {
+        std::cout << "TIERED CACHE:\n";
+        std::cout << "disk       : " << disk_.size() << " / "
+                  << disk_.capacity() << '\n';
+        std::cout << "hits       : " << stats_.memoryHits_ << " memory, "
+                  << stats_.diskHits_ << " disk\n";
+        std::cout << "misses     : " << stats_.misses_ << '\n';
+        std::cout << "demotions  : " << stats_.demotions_ << '\n';
+        memory_.print();
+    }
+};
+
+} // namespace cache
+
+#endif // TIERED_CACHE_HPP
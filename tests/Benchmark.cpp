@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Cache.hpp"
+
+namespace {
+
+const size_t QUERIES_COUNT = 2000000;
+const size_t CACHE_CAPACITY = 1024;
+const int KEYS_COUNT = 16384;
+
+const size_t CONCURRENT_QUERIES_COUNT = 2000000; // per thread
+const double CONCURRENT_HIT_SHARE = 0.99;
+
+const size_t LATENCY_QUERIES_COUNT = 2000000;
+const size_t LATENCY_CAPACITY = 1 << 21;
+
+int getPage(int key) { return key; }
+
+// Skewed trace: most requests go to a small hot set, the rest are uniform.
+std::vector<int> skewedTrace(size_t size, unsigned seed = 42) {
+    std::mt19937 gen(seed);
+    std::geometric_distribution<int> hotDist(1.0 / CACHE_CAPACITY);
+    std::uniform_int_distribution<int> coldDist(0, KEYS_COUNT - 1);
+    std::bernoulli_distribution isHot(0.8);
+
+    std::vector<int> trace(size);
+    for (int &key : trace)
+        key = isHot(gen) ? hotDist(gen) % KEYS_COUNT : coldDist(gen);
+    return trace;
+}
+
+template <CacheType CacheT>
+void runBenchmark(const std::string &name, CacheT &cache,
+                  const std::vector<int> &trace) {
+    auto start = std::chrono::steady_clock::now();
+    int hits = countCacheHits(cache, trace.begin(), trace.end(), getPage);
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns =
+        std::chrono::duration<double, std::nano>(finish - start).count();
+
+    std::cout << std::left << std::setw(12) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10)
+              << ns / trace.size() << " ns/op" << std::setw(10)
+              << 100.0 * hits / trace.size() << " % hits";
+
+    if constexpr (requires { cache.memoryUsage(); })
+        std::cout << std::setw(10)
+                  << static_cast<double>(cache.memoryUsage()) / cache.size()
+                  << " bytes/entry";
+    std::cout << '\n';
+}
+
+// Runs op(key) for every key of trace, timing each call separately, and
+// prints latency percentiles. Every sample includes one clock read.
+template <typename F>
+void runLatencyBenchmark(const std::string &name,
+                         const std::vector<int> &trace, F op) {
+    std::vector<double> samples(trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        op(trace[i]);
+        auto finish = std::chrono::steady_clock::now();
+        samples[i] =
+            std::chrono::duration<double, std::nano>(finish - start).count();
+    }
+
+    auto percentile = [&](double p) {
+        auto it = samples.begin() + static_cast<std::ptrdiff_t>(
+                                        p * (samples.size() - 1));
+        std::nth_element(samples.begin(), it, samples.end());
+        return *it;
+    };
+
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(0) << "p50 " << std::setw(6)
+              << percentile(0.5) << " ns   p99 " << std::setw(6)
+              << percentile(0.99) << " ns   p999 " << std::setw(7)
+              << percentile(0.999) << " ns   max " << std::setw(9)
+              << percentile(1.0) << " ns\n";
+}
+
+// Tail latency while the key set doubles from LATENCY_CAPACITY / 2 to
+// LATENCY_CAPACITY keys: LFUCache is resized once up front and migrates its
+// index a little per call, std::unordered_map rehashes everything at once
+// when it outgrows its buckets. The resize call itself is O(capacity) and
+// is timed separately.
+void runGrowthBenchmarks() {
+    std::mt19937 gen(7);
+    std::vector<int> warmup(LATENCY_CAPACITY / 2);
+    std::iota(warmup.begin(), warmup.end(), 0);
+
+    std::vector<int> trace(LATENCY_QUERIES_COUNT);
+    for (int &key : trace)
+        key = static_cast<int>(gen() % LATENCY_CAPACITY);
+
+    std::cout << "\nlatency, queries : " << LATENCY_QUERIES_COUNT
+              << ", capacity : " << LATENCY_CAPACITY / 2 << " -> "
+              << LATENCY_CAPACITY << '\n';
+
+    cache::LFUCache<int, int> lfu(LATENCY_CAPACITY / 2);
+    countCacheHits(lfu, warmup.begin(), warmup.end(), getPage);
+
+    auto start = std::chrono::steady_clock::now();
+    lfu.resize(LATENCY_CAPACITY);
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << "LFU resize call : " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(finish - start)
+                     .count()
+              << " ms\n";
+
+    runLatencyBenchmark("LFU", trace, [&](int key) {
+        lfu.lookupUpdate(key, getPage);
+    });
+
+    std::unordered_map<int, int> map;
+    for (int key : warmup)
+        map.try_emplace(key, getPage(key));
+    runLatencyBenchmark("unordered_map", trace, [&](int key) {
+        map.try_emplace(key, getPage(key));
+    });
+}
+
+// Read throughput of S3FIFOCache from 1 to 8 threads on a hit-heavy
+// trace: the hot half of the cache is warmed up, and every thread sends
+// CONCURRENT_HIT_SHARE of its queries there.
+void runConcurrentBenchmarks() {
+    std::cout << "\nconcurrent, queries per thread : "
+              << CONCURRENT_QUERIES_COUNT << ", hot share : "
+              << std::fixed << std::setprecision(0)
+              << 100 * CONCURRENT_HIT_SHARE << " %, cores : "
+              << std::thread::hardware_concurrency() << '\n';
+
+    for (unsigned threadsCount : {1, 2, 4, 8}) {
+        cache::S3FIFOCache<int, int> s3fifo(CACHE_CAPACITY);
+        for (int key = 0; key < static_cast<int>(CACHE_CAPACITY / 2); ++key)
+            s3fifo.lookupUpdate(key, getPage);
+
+        std::vector<std::vector<int>> traces(threadsCount);
+        for (unsigned t = 0; t < threadsCount; ++t) {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<int> hotDist(
+                0, static_cast<int>(CACHE_CAPACITY / 2) - 1);
+            std::uniform_int_distribution<int> coldDist(0, KEYS_COUNT - 1);
+            std::bernoulli_distribution isHot(CONCURRENT_HIT_SHARE);
+
+            traces[t].resize(CONCURRENT_QUERIES_COUNT);
+            for (int &key : traces[t])
+                key = isHot(gen) ? hotDist(gen) : coldDist(gen);
+        }
+
+        std::atomic<size_t> hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> threads;
+            for (unsigned t = 0; t < threadsCount; ++t)
+                threads.emplace_back([&, t] {
+                    hits += countCacheHits(s3fifo, traces[t].begin(),
+                                           traces[t].end(), getPage);
+                });
+        }
+        auto finish = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        size_t total = threadsCount * CONCURRENT_QUERIES_COUNT;
+        std::cout << "S3FIFO x" << std::left << std::setw(4) << threadsCount
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << total / seconds / 1e6 << " Mops/s"
+                  << std::setw(10) << 100.0 * hits / total << " % hits\n";
+    }
+}
+
+} // namespace
+
+int main() {
+    std::vector<int> trace = skewedTrace(QUERIES_COUNT);
+
+    std::cout << "queries : " << QUERIES_COUNT
+              << ", capacity : " << CACHE_CAPACITY
+              << ", keys : " << KEYS_COUNT << '\n';
+
+    cache::LFUCache<int, int> lfu(CACHE_CAPACITY);
+    runBenchmark("LFU", lfu, trace);
+
+    cache::StaticLFUCache<int, int, CACHE_CAPACITY> staticLfu;
+    runBenchmark("StaticLFU", staticLfu, trace);
+
+#ifdef CACHE_HAS_SHARED_MEMORY
+    const std::string sharedName = "/lfu_cache_benchmark";
+    cache::SharedLFUCache<int, int, CACHE_CAPACITY> sharedLfu;
+    cache::SharedLFUCache<int, int, CACHE_CAPACITY>::unlink(sharedName);
+    if (sharedLfu.open(sharedName)) {
+        runBenchmark("SharedLFU", sharedLfu, trace);
+        cache::SharedLFUCache<int, int, CACHE_CAPACITY>::unlink(sharedName);
+    }
+#endif
+
+    cache::ARCCache<int, int> arc(CACHE_CAPACITY);
+    runBenchmark("ARC", arc, trace);
+
+    cache::S3FIFOCache<int, int> s3fifo(CACHE_CAPACITY);
+    runBenchmark("S3FIFO", s3fifo, trace);
+
+    cache::SetAssocLFUCache<int, int, 8> setAssoc8(CACHE_CAPACITY);
+    runBenchmark("SetAssoc8", setAssoc8, trace);
+
+    cache::SetAssocLFUCache<int, int, 16> setAssoc16(CACHE_CAPACITY);
+    runBenchmark("SetAssoc16", setAssoc16, trace);
+
+    runConcurrentBenchmarks();
+    runGrowthBenchmarks();
+}
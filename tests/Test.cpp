@@ -1,8 +1,23 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <queue>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -11,6 +26,13 @@
 #include "Generator.hpp"
 #include "TestCache.hpp"
 
+#ifdef CACHE_HAS_SHARED_MEMORY
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
 
@@ -25,17 +47,31 @@ TEST(Auto, BeladyCacheComprasion) {
         test::randomIntVector(QUERIES_COUNT, -1000, 1000);
 
     cache::LFUCache<test::Page, int> LFUcache(CACHE_CAPACITY);
+    cache::ARCCache<test::Page, int> ARCcache(CACHE_CAPACITY);
+    cache::S3FIFOCache<test::Page, int> S3FIFOcache(CACHE_CAPACITY);
+    cache::SetAssocLFUCache<test::Page, int> SetAssocCache(CACHE_CAPACITY);
     cache::BeladyCache<test::Page, int> BeladyCache(
         CACHE_CAPACITY, queries.begin(), queries.end());
 
     int LFUHits = countCacheHits(LFUcache, queries.begin(), queries.end(),
                                  test::slowGetPage);
+    int ARCHits = countCacheHits(ARCcache, queries.begin(), queries.end(),
+                                 test::slowGetPage);
+    int S3FIFOHits = countCacheHits(S3FIFOcache, queries.begin(),
+                                    queries.end(), test::slowGetPage);
+    int SetAssocHits = countCacheHits(SetAssocCache, queries.begin(),
+                                      queries.end(), test::slowGetPage);
     int BeladyHits = countCacheHits(BeladyCache, queries.begin(), queries.end(),
                                     test::slowGetPage);
 
     std::cout << "queries count : " << QUERIES_COUNT << '\n';
-    std::cout << "LFU / Belady hits: " << LFUHits << " / " << BeladyHits
-              << '\n';
+    std::cout << "LFU / ARC / S3FIFO / SetAssoc / Belady hits: " << LFUHits
+              << " / " << ARCHits << " / " << S3FIFOHits << " / "
+              << SetAssocHits << " / " << BeladyHits << '\n';
+
+    EXPECT_LE(ARCHits, BeladyHits);
+    EXPECT_LE(S3FIFOHits, BeladyHits);
+    EXPECT_LE(SetAssocHits, BeladyHits);
 }
 
 // AI GENERATED TESTS:
@@ -199,6 +235,129 @@ TEST(LFU, RepeatedPattern) {
     EXPECT_EQ(hits, 4);
 }
 
+TEST(LFU, CompactMetadata) {
+    const size_t CACHE_CAPACITY = 4096;
+    cache::LFUCache<int, int> lfu(CACHE_CAPACITY);
+
+    for (int key = 0; key < static_cast<int>(CACHE_CAPACITY); ++key)
+        for (int rep = 0; rep <= key % 7; ++rep)
+            lfu.lookupUpdate(key, [](int k) { return k; });
+
+    // 4 key + 4 freq + 2 * 4 links + 8 optional value + two 4-byte index
+    // cells at load factor <= 3/4.
+    double bytesPerEntry =
+        static_cast<double>(lfu.memoryUsage()) / CACHE_CAPACITY;
+    std::cout << "[LFU] bytes/entry=" << bytesPerEntry << '\n';
+
+    EXPECT_EQ(lfu.size(), CACHE_CAPACITY);
+    EXPECT_LT(bytesPerEntry, 40.0);
+}
+
+TEST(LFU, ShrinkEvictsInBatches) {
+    cache::LFUCache<int, int> lfu(100);
+    auto getPage = [](int key) { return key; };
+    for (int key = 0; key < 100; ++key)
+        for (int rep = 0; rep <= key; ++rep)
+            lfu.lookupUpdate(key, getPage);
+
+    lfu.resize(10);
+    EXPECT_EQ(lfu.size(), 100);
+
+    // Every call evicts a bounded batch, the least frequent keys first.
+    EXPECT_TRUE(lfu.lookupUpdate(99, getPage));
+    EXPECT_GT(lfu.size(), 10);
+    EXPECT_LT(lfu.size(), 100);
+
+    for (int i = 0; i < 20; ++i)
+        EXPECT_TRUE(lfu.lookupUpdate(99, getPage));
+    EXPECT_EQ(lfu.size(), 10);
+
+    for (int key = 90; key < 100; ++key)
+        EXPECT_TRUE(lfu.lookupUpdate(key, getPage));
+    EXPECT_FALSE(lfu.lookupUpdate(0, getPage));
+    EXPECT_EQ(lfu.size(), 10);
+}
+
+TEST(LFU, ThrowingLoadLeavesNoEntry) {
+    cache::LFUCache<test::Page, int> lfu(2);
+    auto fail = [](int) -> test::Page { throw std::runtime_error("load"); };
+
+    lfu.lookupUpdate(1, test::slowGetPage);
+    EXPECT_THROW(lfu.lookupUpdate(2, fail), std::runtime_error);
+    EXPECT_EQ(lfu.size(), 1);
+    EXPECT_FALSE(lfu.contains(2));
+
+    lfu.lookupUpdate(1, test::slowGetPage);
+    lfu.lookupUpdate(3, test::slowGetPage);
+    EXPECT_THROW(lfu.lookupUpdate(4, fail), std::runtime_error);
+    EXPECT_EQ(lfu.size(), 1);
+    EXPECT_FALSE(lfu.lookupUpdate(5, test::slowGetPage));
+    EXPECT_FALSE(lfu.lookupUpdate(6, test::slowGetPage));
+    EXPECT_EQ(lfu.size(), 2);
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_TRUE(lfu.lookupUpdate(6, test::slowGetPage));
+}
+
+TEST(LFU, GrowKeepsEntries) {
+    const int OLD_CAPACITY = 64;
+    const int NEW_CAPACITY = 1024;
+    cache::LFUCache<int, int> lfu(OLD_CAPACITY);
+    auto getPage = [](int key) { return key; };
+    for (int key = 0; key < OLD_CAPACITY; ++key)
+        lfu.lookupUpdate(key, getPage);
+
+    lfu.resize(NEW_CAPACITY);
+
+    // Lookups see entries in both the old and the new index cells while
+    // they migrate.
+    for (int key = 0; key < OLD_CAPACITY; ++key)
+        EXPECT_TRUE(lfu.lookupUpdate(key, getPage));
+    for (int key = OLD_CAPACITY; key < NEW_CAPACITY; ++key)
+        EXPECT_FALSE(lfu.lookupUpdate(key, getPage));
+    EXPECT_EQ(lfu.size(), NEW_CAPACITY);
+
+    for (int key = 0; key < NEW_CAPACITY; ++key)
+        EXPECT_TRUE(lfu.lookupUpdate(key, getPage));
+}
+
+TEST(IndexTable, GrowMigratesIncrementally) {
+    std::vector<int> keys(4096);
+    std::iota(keys.begin(), keys.end(), 0);
+    auto keyOf = [&](uint32_t id) { return keys[id]; };
+
+    cache::IndexTable<int> table(64);
+    std::unordered_set<uint32_t> present;
+    std::mt19937 gen(5);
+
+    for (int step = 0; step < 20000; ++step) {
+        if (step == 5000)
+            table.grow(1024);
+        if (step == 5005) {
+            // Chains onto the running migration instead of finishing it.
+            ASSERT_TRUE(table.migrating());
+            table.grow(2048);
+        }
+        if (step == 6000)
+            table.grow(4096);
+
+        size_t limit = step < 5000 ? 64 : step < 6000 ? 1024 : 4096;
+        uint32_t id = static_cast<uint32_t>(gen() % limit);
+        if (present.contains(id)) {
+            table.erase(keys[id], keyOf);
+            present.erase(id);
+        } else if (present.size() < limit) {
+            table.assign(keys[id], id, keyOf);
+            present.insert(id);
+        }
+        table.migrate(4, keyOf);
+
+        uint32_t probe = static_cast<uint32_t>(gen() % keys.size());
+        ASSERT_EQ(table.find(keys[probe], keyOf) != cache::IndexTable<int>::NIL,
+                  present.contains(probe));
+    }
+    EXPECT_FALSE(table.migrating());
+}
+
 // ---------------- Belady tests ----------------
 
 TEST(Belady, BasicHit2) {
@@ -432,4 +591,1058 @@ TEST(LFUCacheOverhit, PureOverhitTest_7126) {
             return; // No point continuing this run
         }
     }
-}
\ No newline at end of file
+}
+// ---------------- ARC tests ----------------
+
+TEST(ARC, BasicHit) {
+    cache::ARCCache<test::Page, int> arc(2);
+
+    std::vector<int> queries = {1, 2, 1}; // miss, miss, hit
+    int hits =
+        countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_EQ(hits, 1);
+}
+
+TEST(ARC, RepeatedPattern) {
+    cache::ARCCache<test::Page, int> arc(2);
+
+    std::vector<int> queries = {1, 2, 1, 2, 1, 2};
+    int hits =
+        countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_EQ(hits, 4);
+}
+
+TEST(ARC, CapacityCheck) {
+    cache::ARCCache<test::Page, int> arc(2);
+
+    std::vector<int> queries = {1, 2, 3};
+    countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+
+    int hits =
+        countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+    EXPECT_LE(hits, 2);
+}
+
+TEST(ARC, ScanResistance) {
+    cache::ARCCache<test::Page, int> arc(2);
+
+    // 2 is referenced twice and lands in T2, the one-shot scan 3, 4, 5 only
+    // churns T1 and doesn't push 2 out.
+    std::vector<int> queries = {1, 1, 2, 2, 3, 4, 5};
+    countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_TRUE(arc.lookupUpdate(2, test::slowGetPage));
+    EXPECT_TRUE(arc.lookupUpdate(5, test::slowGetPage));
+    EXPECT_FALSE(arc.lookupUpdate(3, test::slowGetPage));
+}
+
+TEST(ARC, GhostHitIsMiss) {
+    cache::ARCCache<test::Page, int> arc(1);
+
+    EXPECT_FALSE(arc.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(arc.lookupUpdate(2, test::slowGetPage)); // 1 -> B1
+    EXPECT_FALSE(arc.lookupUpdate(1, test::slowGetPage)); // ghost hit, reload
+    EXPECT_TRUE(arc.lookupUpdate(1, test::slowGetPage));
+}
+
+TEST(ARC, ThrowingLoadLeavesNoEntry) {
+    cache::ARCCache<test::Page, int> arc(2);
+    auto fail = [](int) -> test::Page { throw std::runtime_error("load"); };
+
+    // 2 is a ghost by now: the failed load must neither demote a resident
+    // nor drop the ghost.
+    for (int key : {1, 1, 2, 3})
+        arc.lookupUpdate(key, test::slowGetPage);
+    EXPECT_THROW(arc.lookupUpdate(2, fail), std::runtime_error);
+    EXPECT_THROW(arc.lookupUpdate(5, fail), std::runtime_error);
+
+    EXPECT_FALSE(arc.lookupUpdate(4, test::slowGetPage));
+    EXPECT_FALSE(arc.lookupUpdate(2, test::slowGetPage));
+    EXPECT_TRUE(arc.lookupUpdate(2, test::slowGetPage));
+}
+
+TEST(ARC, ZeroCapacity) {
+    cache::ARCCache<test::Page, int> arc(0);
+
+    EXPECT_FALSE(arc.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(arc.lookupUpdate(1, test::slowGetPage));
+}
+
+TEST(Compare, PhaseChange) {
+    const int CACHE_CAP = 100;
+
+    // Frequency phase: a small hot set hammered many times. Recency phase: a
+    // sliding window over fresh keys, where old frequency only gets in the way.
+    std::vector<int> queries;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> hotDist(0, 79);
+    for (int i = 0; i < 20000; ++i)
+        queries.push_back(hotDist(gen));
+    for (int base = 1000; base < 11000; base += 50)
+        for (int rep = 0; rep < 4; ++rep)
+            for (int i = 0; i < 50; ++i)
+                queries.push_back(base + i);
+
+    cache::LFUCache<test::Page, int> lfu(CACHE_CAP);
+    cache::ARCCache<test::Page, int> arc(CACHE_CAP);
+    cache::BeladyCache<test::Page, int> Belady(CACHE_CAP, queries.begin(),
+                                               queries.end());
+
+    int lfu_hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+    int arc_hits =
+        countCacheHits(arc, queries.begin(), queries.end(), test::slowGetPage);
+    int Belady_hits = countCacheHits(Belady, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+
+    std::cout << "[PhaseChange] LFU_hits=" << lfu_hits
+              << " ARC_hits=" << arc_hits << " Belady_hits=" << Belady_hits
+              << " of " << queries.size() << '\n';
+
+    EXPECT_LE(arc_hits, Belady_hits);
+    EXPECT_GE(arc_hits, lfu_hits);
+}
+
+// ---------------- S3FIFO tests ----------------
+
+TEST(S3FIFO, BasicHit) {
+    cache::S3FIFOCache<test::Page, int> s3fifo(2);
+
+    std::vector<int> queries = {1, 2, 1}; // miss, miss, hit
+    int hits = countCacheHits(s3fifo, queries.begin(), queries.end(),
+                              test::slowGetPage);
+
+    EXPECT_EQ(hits, 1);
+}
+
+TEST(S3FIFO, CapacityCheck) {
+    cache::S3FIFOCache<test::Page, int> s3fifo(2);
+
+    std::vector<int> queries = {1, 2, 3};
+    countCacheHits(s3fifo, queries.begin(), queries.end(), test::slowGetPage);
+
+    int hits = countCacheHits(s3fifo, queries.begin(), queries.end(),
+                              test::slowGetPage);
+    EXPECT_LE(hits, 2);
+}
+
+TEST(S3FIFO, HitEntrySurvivesScan) {
+    cache::S3FIFOCache<test::Page, int> s3fifo(10);
+
+    // 1 is hit while on probation, so the scan promotes it to the main queue
+    // instead of evicting it.
+    EXPECT_FALSE(s3fifo.lookupUpdate(1, test::slowGetPage));
+    EXPECT_TRUE(s3fifo.lookupUpdate(1, test::slowGetPage));
+    for (int key = 100; key < 120; ++key)
+        s3fifo.lookupUpdate(key, test::slowGetPage);
+
+    EXPECT_TRUE(s3fifo.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(s3fifo.lookupUpdate(100, test::slowGetPage));
+}
+
+TEST(S3FIFO, GhostReadmitsToMain) {
+    cache::S3FIFOCache<test::Page, int> s3fifo(10);
+
+    // 1 is evicted from probation straight into the ghost queue; its second
+    // miss readmits it into the main queue where it outlives the next scan.
+    s3fifo.lookupUpdate(1, test::slowGetPage);
+    for (int key = 100; key < 110; ++key)
+        s3fifo.lookupUpdate(key, test::slowGetPage);
+    EXPECT_FALSE(s3fifo.lookupUpdate(1, test::slowGetPage));
+
+    for (int key = 200; key < 205; ++key)
+        s3fifo.lookupUpdate(key, test::slowGetPage);
+    EXPECT_TRUE(s3fifo.lookupUpdate(1, test::slowGetPage));
+}
+
+TEST(S3FIFO, ConcurrentLookups) {
+    const size_t CACHE_CAPACITY = 1000;
+    const int THREADS_COUNT = 4;
+    const int QUERIES_PER_THREAD = 50000;
+
+    cache::S3FIFOCache<test::Page, int> s3fifo(CACHE_CAPACITY);
+    auto getPage = [](int key) { return test::Page(key); };
+
+    std::vector<int> threadHits(THREADS_COUNT, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            std::geometric_distribution<int> dist(0.002);
+            for (int i = 0; i < QUERIES_PER_THREAD; ++i)
+                threadHits[t] += s3fifo.lookupUpdate(dist(gen), getPage);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    int hits = 0;
+    for (int threadHit : threadHits)
+        hits += threadHit;
+
+    std::cout << "[S3FIFO concurrent] hits=" << hits << " of "
+              << THREADS_COUNT * QUERIES_PER_THREAD << '\n';
+
+    EXPECT_GT(hits, THREADS_COUNT * QUERIES_PER_THREAD / 2);
+}
+
+TEST(StripedSharedMutex, WritersExcludeReaders) {
+    const int THREADS_COUNT = 8;
+    const int ROUNDS = 20000;
+
+    cache::StripedSharedMutex mutex;
+    int first = 0;
+    int second = 0;
+    std::atomic<int> torn = 0;
+
+    // Even threads write both fields, odd ones check they never differ.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < ROUNDS; ++i) {
+                if (t % 2 == 0) {
+                    std::unique_lock lock(mutex);
+                    first++;
+                    second++;
+                } else {
+                    std::shared_lock lock(mutex);
+                    torn += first != second;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(first, THREADS_COUNT / 2 * ROUNDS);
+}
+
+TEST(S3FIFO, SlowMissDoesNotBlockHits) {
+    cache::S3FIFOCache<int, int> s3fifo(10);
+    s3fifo.lookupUpdate(1, [](int key) { return key; });
+
+    std::atomic<bool> loading = false;
+    std::atomic<bool> released = false;
+    bool releasedInTime = false;
+
+    std::thread loader([&] {
+        s3fifo.lookupUpdate(2, [&](int key) {
+            loading = true;
+            auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (!released && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            releasedInTime = released;
+            return key;
+        });
+    });
+
+    while (!loading)
+        std::this_thread::yield();
+    EXPECT_TRUE(s3fifo.lookupUpdate(1, [](int key) { return key; }));
+    released = true;
+    loader.join();
+
+    EXPECT_TRUE(releasedInTime);
+    EXPECT_TRUE(s3fifo.lookupUpdate(2, [](int key) { return key; }));
+}
+
+// ---------------- getOrLoad tests ----------------
+
+namespace {
+
+// Neither copyable nor movable: only in-place construction can cache it.
+struct PinnedPage {
+    int val_;
+    explicit PinnedPage(int val) : val_(val) {}
+    PinnedPage(const PinnedPage &) = delete;
+    PinnedPage &operator=(const PinnedPage &) = delete;
+};
+
+} // namespace
+
+TEST(GetOrLoad, LFUReturnsCachedValue) {
+    cache::LFUCache<std::unique_ptr<int>, int> lfu(2);
+
+    int loads = 0;
+    auto load = [&loads](int key) {
+        ++loads;
+        return std::make_unique<int>(key * 10);
+    };
+
+    std::unique_ptr<int> &first = lfu.getOrLoad(1, load);
+    EXPECT_EQ(*first, 10);
+
+    std::unique_ptr<int> &second = lfu.getOrLoad(1, load);
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(loads, 1);
+
+    EXPECT_EQ(*lfu.getOrLoad(2, load), 20);
+    EXPECT_EQ(*lfu.getOrLoad(3, load), 30); // evicts 2
+    EXPECT_EQ(loads, 3);
+    EXPECT_TRUE(lfu.lookupUpdate(1, load));
+    EXPECT_EQ(loads, 3);
+}
+
+TEST(GetOrLoad, LFUZeroCapacity) {
+    cache::LFUCache<std::unique_ptr<int>, int> lfu(0);
+    auto load = [](int key) { return std::make_unique<int>(key); };
+
+    EXPECT_EQ(*lfu.getOrLoad(7, load), 7);
+    EXPECT_EQ(*lfu.getOrLoad(8, load), 8);
+}
+
+TEST(GetOrLoad, ARCReturnsCachedValue) {
+    cache::ARCCache<std::unique_ptr<int>, int> arc(1);
+
+    int loads = 0;
+    auto load = [&loads](int key) {
+        ++loads;
+        return std::make_unique<int>(key * 10);
+    };
+
+    EXPECT_EQ(*arc.getOrLoad(1, load), 10);
+    EXPECT_EQ(*arc.getOrLoad(1, load), 10);
+    EXPECT_EQ(*arc.getOrLoad(2, load), 20);
+    EXPECT_EQ(*arc.getOrLoad(1, load), 10); // ghost hit reloads
+    EXPECT_EQ(loads, 3);
+}
+
+TEST(GetOrLoad, BeladyBypassStillReturnsValue) {
+    std::vector<int> queries = {1, 2, 3, 1, 2};
+    cache::BeladyCache<std::unique_ptr<int>, int> Belady(2, queries.begin(),
+                                                         queries.end());
+
+    int loads = 0;
+    auto load = [&loads](int key) {
+        ++loads;
+        return std::make_unique<int>(key * 10);
+    };
+
+    EXPECT_EQ(*Belady.getOrLoad(1, load), 10);
+    EXPECT_EQ(*Belady.getOrLoad(2, load), 20);
+    EXPECT_EQ(*Belady.getOrLoad(3, load), 30); // never requested again: bypass
+    EXPECT_EQ(*Belady.getOrLoad(1, load), 10);
+    EXPECT_EQ(*Belady.getOrLoad(2, load), 20);
+    EXPECT_EQ(loads, 3);
+}
+
+TEST(GetOrLoad, LookupUpdateBypassDoesNotLoad) {
+    int loads = 0;
+    auto load = [&loads](int key) {
+        ++loads;
+        return key;
+    };
+
+    cache::LFUCache<int, int> lfu(0);
+    cache::ARCCache<int, int> arc(0);
+    cache::SetAssocLFUCache<int, int> setAssoc(0);
+    for (int key : {1, 2}) {
+        EXPECT_FALSE(lfu.lookupUpdate(key, load));
+        EXPECT_FALSE(arc.lookupUpdate(key, load));
+        EXPECT_FALSE(setAssoc.lookupUpdate(key, load));
+    }
+    EXPECT_EQ(loads, 0);
+
+    // 3 is never requested again, so it isn't cached.
+    std::vector<int> queries = {1, 2, 3, 1, 2};
+    cache::BeladyCache<int, int> Belady(2, queries.begin(), queries.end());
+    cache::OnlineBeladyCache<int, int> online(2, queries.size(),
+                                              queries.begin(), queries.end());
+    EXPECT_EQ(countCacheHits(Belady, queries.begin(), queries.end(), load), 2);
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(countCacheHits(online, queries.begin(), queries.end(), load), 2);
+    EXPECT_EQ(loads, 4);
+}
+
+TEST(GetOrLoad, NonMovableValues) {
+    auto load = [](int key) { return PinnedPage(key); };
+    std::vector<int> queries = {1, 2, 1, 3, 1};
+
+    cache::LFUCache<PinnedPage, int> lfu(2);
+    cache::ARCCache<PinnedPage, int> arc(2);
+    cache::BeladyCache<PinnedPage, int> Belady(2, queries.begin(),
+                                               queries.end());
+
+    for (int q : queries) {
+        EXPECT_EQ(lfu.getOrLoad(q, load).val_, q);
+        EXPECT_EQ(arc.getOrLoad(q, load).val_, q);
+        EXPECT_EQ(Belady.getOrLoad(q, load).val_, q);
+    }
+}
+
+// ---------------- StaticLFU tests ----------------
+
+namespace {
+
+constexpr int staticLFUHits() {
+    cache::StaticLFUCache<int, int, 2> lfu;
+
+    int hits = 0;
+    for (int q : {1, 2, 1, 3, 1, 3, 1})
+        hits += lfu.lookupUpdate(q, [](int key) { return key; });
+    return hits;
+}
+
+} // namespace
+
+static_assert(staticLFUHits() == 4);
+
+TEST(StaticLFU, EvictLeastFrequent) {
+    cache::StaticLFUCache<test::Page, int, 2> lfu;
+
+    std::vector<int> queries = {1, 2, 1, 3};
+    int hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_EQ(hits, 1);
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(lfu.lookupUpdate(2, test::slowGetPage));
+}
+
+TEST(StaticLFU, GetOrLoad) {
+    cache::StaticLFUCache<std::unique_ptr<int>, int, 1> lfu;
+    auto load = [](int key) { return std::make_unique<int>(key * 10); };
+
+    std::unique_ptr<int> &first = lfu.getOrLoad(1, load);
+    EXPECT_EQ(*first, 10);
+    EXPECT_EQ(&lfu.getOrLoad(1, load), &first);
+    EXPECT_EQ(*lfu.getOrLoad(2, load), 20);
+}
+
+TEST(StaticLFU, ThrowingLoadLeavesNoEntry) {
+    cache::StaticLFUCache<test::Page, int, 2> lfu;
+    auto fail = [](int) -> test::Page { throw std::runtime_error("load"); };
+
+    lfu.lookupUpdate(1, test::slowGetPage);
+    EXPECT_THROW(lfu.lookupUpdate(2, fail), std::runtime_error);
+    EXPECT_EQ(lfu.size(), 1);
+    EXPECT_FALSE(lfu.contains(2));
+
+    // The node the failed load took is reused, the others stay intact.
+    lfu.lookupUpdate(1, test::slowGetPage);
+    lfu.lookupUpdate(3, test::slowGetPage);
+    EXPECT_THROW(lfu.lookupUpdate(4, fail), std::runtime_error);
+    EXPECT_EQ(lfu.size(), 1);
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(lfu.lookupUpdate(5, test::slowGetPage));
+    EXPECT_FALSE(lfu.lookupUpdate(6, test::slowGetPage));
+    EXPECT_EQ(lfu.size(), 2);
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_TRUE(lfu.lookupUpdate(6, test::slowGetPage));
+}
+
+TEST(StaticLFU, MatchesLFUCache) {
+    const size_t QUERIES_COUNT = 100000;
+    const size_t CACHE_CAPACITY = 64;
+
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, -200, 200);
+    std::mt19937 gen(3);
+    std::geometric_distribution<int> hotDist(0.05);
+    for (int &q : queries)
+        if (gen() % 2)
+            q = hotDist(gen);
+
+    cache::LFUCache<test::Page, int> lfu(CACHE_CAPACITY);
+    cache::StaticLFUCache<test::Page, int, CACHE_CAPACITY> staticLfu;
+
+    // Same eviction order means the same verdict on every single query.
+    for (int q : queries)
+        ASSERT_EQ(lfu.lookupUpdate(q, test::slowGetPage),
+                  staticLfu.lookupUpdate(q, test::slowGetPage));
+}
+
+// ---------------- SetAssocLFU tests ----------------
+
+TEST(SetAssocLFU, BasicHit) {
+    cache::SetAssocLFUCache<test::Page, int> lfu(2);
+
+    std::vector<int> queries = {1, 2, 1}; // miss, miss, hit
+    int hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_EQ(hits, 1);
+}
+
+TEST(SetAssocLFU, SingleSetIsExactLFU) {
+    // With capacity <= Ways everything lands in one set, so eviction is
+    // plain LFU over the whole cache.
+    cache::SetAssocLFUCache<test::Page, int> lfu(2);
+
+    std::vector<int> queries = {1, 2, 1, 3};
+    countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_FALSE(lfu.lookupUpdate(2, test::slowGetPage));
+}
+
+TEST(SetAssocLFU, NeverExceedsCapacity) {
+    const size_t CACHE_CAPACITY = 100;
+    cache::SetAssocLFUCache<test::Page, int, 16> lfu(CACHE_CAPACITY);
+
+    std::vector<int> keys(1000);
+    std::iota(keys.begin(), keys.end(), 0);
+    countCacheHits(lfu, keys.begin(), keys.end(), test::slowGetPage);
+
+    int hits =
+        countCacheHits(lfu, keys.begin(), keys.end(), test::slowGetPage);
+    EXPECT_LE(hits, static_cast<int>(CACHE_CAPACITY));
+}
+
+TEST(SetAssocLFU, ThrowingLoadLeavesNoEntry) {
+    cache::SetAssocLFUCache<test::Page, int> lfu(1);
+    auto fail = [](int) -> test::Page { throw std::runtime_error("load"); };
+
+    lfu.lookupUpdate(1, test::slowGetPage);
+    EXPECT_THROW(lfu.lookupUpdate(2, fail), std::runtime_error);
+    EXPECT_FALSE(lfu.lookupUpdate(1, test::slowGetPage));
+    EXPECT_TRUE(lfu.lookupUpdate(1, test::slowGetPage));
+}
+
+TEST(SetAssocLFU, GetOrLoad) {
+    cache::SetAssocLFUCache<std::unique_ptr<int>, int> lfu(64);
+    auto load = [](int key) { return std::make_unique<int>(key * 10); };
+
+    for (int key = 0; key < 32; ++key)
+        EXPECT_EQ(*lfu.getOrLoad(key, load), key * 10);
+    for (int key = 0; key < 32; ++key)
+        EXPECT_EQ(*lfu.getOrLoad(key, load), key * 10);
+}
+
+TEST(Compare, SetAssocSkewed) {
+    const size_t QUERIES_COUNT = 200000;
+    const size_t CACHE_CAPACITY = 1024;
+
+    std::mt19937 gen(11);
+    std::geometric_distribution<int> hotDist(1.0 / CACHE_CAPACITY);
+    std::vector<int> queries(QUERIES_COUNT);
+    for (int &q : queries)
+        q = hotDist(gen);
+
+    cache::LFUCache<test::Page, int> lfu(CACHE_CAPACITY);
+    cache::SetAssocLFUCache<test::Page, int, 8> setAssoc8(CACHE_CAPACITY);
+    cache::SetAssocLFUCache<test::Page, int, 16> setAssoc16(CACHE_CAPACITY);
+    cache::BeladyCache<test::Page, int> Belady(CACHE_CAPACITY, queries.begin(),
+                                               queries.end());
+
+    int lfu_hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+    int setAssoc8_hits = countCacheHits(setAssoc8, queries.begin(),
+                                        queries.end(), test::slowGetPage);
+    int setAssoc16_hits = countCacheHits(setAssoc16, queries.begin(),
+                                         queries.end(), test::slowGetPage);
+    int Belady_hits = countCacheHits(Belady, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+
+    std::cout << "[SetAssocSkewed] LFU_hits=" << lfu_hits
+              << " SetAssoc8_hits=" << setAssoc8_hits
+              << " SetAssoc16_hits=" << setAssoc16_hits
+              << " Belady_hits=" << Belady_hits << " of " << QUERIES_COUNT
+              << '\n';
+
+    EXPECT_LE(setAssoc8_hits, Belady_hits);
+    EXPECT_LE(setAssoc16_hits, Belady_hits);
+}
+
+// ---------------- Snapshot tests ----------------
+
+namespace {
+
+// Unique per process, so parallel test runs don't share files.
+std::string tempFilePath(const std::string &name) {
+    static const unsigned runId = std::random_device{}();
+    return (std::filesystem::temp_directory_path() /
+            ("lfu_cache_" + name + "_" + std::to_string(runId)))
+        .string();
+}
+
+} // namespace
+
+TEST(Snapshot, RestoredCacheBehavesTheSame) {
+    const size_t CACHE_CAPACITY = 64;
+    const int QUERIES_COUNT = 20000;
+    std::vector<int> warmup = uniformQueries(QUERIES_COUNT, 0, 200, 1);
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, 0, 200, 2);
+    auto getPage = [](int key) { return key; };
+
+    cache::LFUCache<int, int> original(CACHE_CAPACITY);
+    countCacheHits(original, warmup.begin(), warmup.end(), getPage);
+
+    std::string path = tempFilePath("same");
+    ASSERT_TRUE(original.saveSnapshot(path));
+
+    cache::LFUCache<int, int> restored(CACHE_CAPACITY);
+    ASSERT_TRUE(restored.loadSnapshot(path));
+    std::filesystem::remove(path);
+    EXPECT_EQ(restored.size(), original.size());
+
+    for (int key : queries)
+        ASSERT_EQ(restored.lookupUpdate(key, getPage),
+                  original.lookupUpdate(key, getPage));
+}
+
+TEST(Snapshot, TrivialValuesNeedNoReload) {
+    cache::LFUCache<int, int> original(4);
+    for (int key : {1, 2, 2, 3, 3, 3})
+        original.lookupUpdate(key, [](int k) { return k * 10; });
+
+    std::string path = tempFilePath("values");
+    ASSERT_TRUE(original.saveSnapshot(path));
+
+    cache::LFUCache<int, int> restored(4);
+    ASSERT_TRUE(restored.loadSnapshot(path));
+    std::filesystem::remove(path);
+
+    int loads = 0;
+    auto countingGetPage = [&](int key) {
+        ++loads;
+        return key;
+    };
+    EXPECT_TRUE(restored.lookupUpdate(1, countingGetPage));
+    EXPECT_EQ(restored.getOrLoad(3, countingGetPage), 30);
+    EXPECT_EQ(loads, 0);
+}
+
+TEST(Snapshot, OtherValuesAreReloadedOnFirstUse) {
+    cache::LFUCache<std::string, int> original(2);
+    auto getPage = [](int key) { return std::to_string(key); };
+    for (int key : {1, 1, 1, 2, 2})
+        original.lookupUpdate(key, getPage);
+
+    std::string path = tempFilePath("lazy");
+    ASSERT_TRUE(original.saveSnapshot(path));
+
+    cache::LFUCache<std::string, int> restored(2);
+    ASSERT_TRUE(restored.loadSnapshot(path));
+    std::filesystem::remove(path);
+
+    // First access loads the data, after that it's a plain hit. Key 2 was
+    // never touched, but its restored frequency makes it the victim.
+    EXPECT_FALSE(restored.lookupUpdate(1, getPage));
+    EXPECT_TRUE(restored.lookupUpdate(1, getPage));
+    EXPECT_FALSE(restored.lookupUpdate(3, getPage));
+    EXPECT_EQ(restored.getOrLoad(1, getPage), "1");
+    EXPECT_FALSE(restored.lookupUpdate(2, getPage));
+}
+
+TEST(Snapshot, ShrinksToCapacity) {
+    cache::LFUCache<int, int> original(4);
+    for (int key : {1, 1, 1, 2, 2, 3, 4, 4, 4, 4})
+        original.lookupUpdate(key, [](int k) { return k; });
+
+    std::string path = tempFilePath("shrink");
+    ASSERT_TRUE(original.saveSnapshot(path));
+
+    cache::LFUCache<int, int> restored(2);
+    ASSERT_TRUE(restored.loadSnapshot(path));
+    std::filesystem::remove(path);
+
+    auto getPage = [](int k) { return k; };
+    EXPECT_EQ(restored.size(), 2);
+    EXPECT_TRUE(restored.lookupUpdate(1, getPage));
+    EXPECT_TRUE(restored.lookupUpdate(4, getPage));
+    EXPECT_FALSE(restored.lookupUpdate(2, getPage));
+}
+
+TEST(Snapshot, CorruptFileIsRejected) {
+    cache::LFUCache<int, int> original(8);
+    for (int key = 0; key < 8; ++key)
+        original.lookupUpdate(key, [](int k) { return k; });
+
+    std::string path = tempFilePath("corrupt");
+    ASSERT_TRUE(original.saveSnapshot(path));
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in |
+                                    std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+
+    cache::LFUCache<int, int> restored(8);
+    restored.lookupUpdate(42, [](int k) { return k; });
+
+    EXPECT_FALSE(restored.loadSnapshot(path));
+    EXPECT_FALSE(restored.loadSnapshot(path + ".missing"));
+    std::filesystem::remove(path);
+
+    cache::LFUCache<long, int> otherValues(8);
+    ASSERT_TRUE(original.saveSnapshot(path));
+    EXPECT_FALSE(otherValues.loadSnapshot(path));
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(restored.size(), 1);
+    EXPECT_TRUE(restored.lookupUpdate(42, [](int k) { return k; }));
+}
+
+// Lets patch edit the payload of a snapshot of LFUCache<int, int>, then
+// fixes up the checksum, so only the semantic checks can catch the edit.
+template <typename F>
+static void patchSnapshot(const std::string &path, F patch) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), {});
+    in.close();
+
+    cache::LFUSnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    char *payload = bytes.data() + sizeof(header);
+    int *keys = reinterpret_cast<int *>(payload);
+    uint32_t *freqs = reinterpret_cast<uint32_t *>(keys + header.size_);
+    patch(keys, freqs);
+
+    header.checksum_ =
+        cache::snapshotChecksum(payload, bytes.size() - sizeof(header));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+TEST(Snapshot, InconsistentFileIsRejected) {
+    auto getPage = [](int k) { return k; };
+    cache::LFUCache<int, int> original(4);
+    for (int key : {1, 2, 2, 3, 3, 3})
+        original.lookupUpdate(key, getPage);
+
+    std::string path = tempFilePath("inconsistent");
+    cache::LFUCache<int, int> restored(4);
+    restored.lookupUpdate(42, getPage);
+
+    // List order is 1, 2, 3 with frequencies 0, 1, 2.
+    ASSERT_TRUE(original.saveSnapshot(path));
+    patchSnapshot(path, [](int *, uint32_t *freqs) { freqs[1] = 7; });
+    EXPECT_FALSE(restored.loadSnapshot(path));
+
+    ASSERT_TRUE(original.saveSnapshot(path));
+    patchSnapshot(path, [](int *keys, uint32_t *) { keys[2] = 1; });
+    EXPECT_FALSE(restored.loadSnapshot(path));
+
+    ASSERT_TRUE(original.saveSnapshot(path));
+    patchSnapshot(path, [](int *, uint32_t *freqs) { freqs[0] = 1; });
+    EXPECT_FALSE(restored.loadSnapshot(path));
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(restored.size(), 1);
+    EXPECT_TRUE(restored.lookupUpdate(42, getPage));
+}
+
+TEST(Snapshot, FailedSaveLeavesNoTempFile) {
+    cache::LFUCache<int, int> lfu(4);
+    lfu.lookupUpdate(1, [](int k) { return k; });
+
+    // rename() can't replace a non-empty directory.
+    std::string path = tempFilePath("save_dir");
+    std::filesystem::create_directories(path + "/entry");
+    EXPECT_FALSE(lfu.saveSnapshot(path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove_all(path);
+
+    ASSERT_TRUE(lfu.saveSnapshot(path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+// ---------------- Tiered cache tests ----------------
+
+TEST(Tiered, DiskEvictsInDemotionOrder) {
+    cache::FileTier<int, char> disk(tempFilePath("tier_fifo"), 3);
+    for (char key : {'A', 'B', 'C'})
+        ASSERT_TRUE(disk.put(key, key));
+    EXPECT_EQ(disk.take('B'), 'B');
+
+    // D refills B's slot but is still the newest entry.
+    for (char key : {'D', 'E', 'F'})
+        ASSERT_TRUE(disk.put(key, key));
+    EXPECT_FALSE(disk.contains('A'));
+    EXPECT_FALSE(disk.contains('C'));
+    for (char key : {'D', 'E', 'F'})
+        EXPECT_TRUE(disk.contains(key));
+}
+
+TEST(Tiered, DemotedEntriesComeBackFromDisk) {
+    cache::TieredCache<int, int> tiered(4, 16, tempFilePath("tiered_basic"));
+
+    int loads = 0;
+    auto countingGetPage = [&](int key) {
+        ++loads;
+        return key * 10;
+    };
+
+    for (int key = 0; key < 12; ++key)
+        EXPECT_FALSE(tiered.lookupUpdate(key, countingGetPage));
+    EXPECT_EQ(tiered.size(), 12);
+
+    for (int key = 0; key < 12; ++key)
+        EXPECT_EQ(tiered.getOrLoad(key, countingGetPage), key * 10);
+
+    EXPECT_EQ(loads, 12);
+    EXPECT_EQ(tiered.stats().misses_, 12);
+    EXPECT_GT(tiered.stats().diskHits_, 0);
+    EXPECT_EQ(tiered.stats().memoryHits_ + tiered.stats().diskHits_, 12);
+}
+
+TEST(Tiered, FullDiskDropsEntries) {
+    cache::TieredCache<int, int> tiered(2, 3, tempFilePath("tiered_full"));
+    auto getPage = [](int key) { return key; };
+
+    for (int key = 0; key < 10; ++key)
+        tiered.lookupUpdate(key, getPage);
+    EXPECT_EQ(tiered.size(), 5);
+
+    int hits = 0;
+    for (int key = 0; key < 10; ++key)
+        hits += tiered.lookupUpdate(key, getPage);
+    EXPECT_LT(hits, 10);
+}
+
+TEST(Compare, TieredVsMemoryOnly) {
+    const size_t MEMORY_CAPACITY = 32;
+    const size_t DISK_CAPACITY = 256;
+    const int QUERIES_COUNT = 20000;
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, 0, 300);
+    auto getPage = [](int key) { return key; };
+
+    cache::LFUCache<int, int> lfu(MEMORY_CAPACITY);
+    cache::TieredCache<int, int> tiered(MEMORY_CAPACITY, DISK_CAPACITY,
+                                        tempFilePath("tiered_compare"));
+
+    int lfu_hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), getPage);
+    int tiered_hits =
+        countCacheHits(tiered, queries.begin(), queries.end(), getPage);
+
+    std::cout << "[TieredVsMemoryOnly] LFU_hits=" << lfu_hits
+              << " Tiered_hits=" << tiered_hits
+              << " (disk=" << tiered.stats().diskHits_ << ") of "
+              << QUERIES_COUNT << '\n';
+
+    EXPECT_GT(tiered_hits, lfu_hits);
+    EXPECT_EQ(static_cast<size_t>(QUERIES_COUNT - tiered_hits),
+              tiered.stats().misses_);
+}
+
+// ---------------- Shared memory tests ----------------
+
+#ifdef CACHE_HAS_SHARED_MEMORY
+
+namespace {
+
+using SharedCache = cache::SharedLFUCache<int, int, 64>;
+
+std::string sharedName(const std::string &name) {
+    return "/lfu_cache_" + name + "_" + std::to_string(getpid());
+}
+
+// Runs body in a child process and returns its exit code.
+template <typename F> int runInChild(F body) {
+    pid_t child = fork();
+    if (child == 0)
+        _exit(body());
+
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status))
+        return -1;
+    return WEXITSTATUS(status);
+}
+
+} // namespace
+
+TEST(SharedLFU, ProcessesShareEntries) {
+    std::string name = sharedName("share");
+    SharedCache shared;
+    ASSERT_TRUE(shared.open(name));
+
+    int exitCode = runInChild([&] {
+        SharedCache worker;
+        if (!worker.open(name))
+            return 1;
+        for (int key = 0; key < 32; ++key)
+            worker.lookupUpdate(key, [](int k) { return k * 10; });
+        return 0;
+    });
+    EXPECT_EQ(exitCode, 0);
+
+    int loads = 0;
+    auto countingGetPage = [&](int key) {
+        ++loads;
+        return key;
+    };
+    for (int key = 0; key < 32; ++key)
+        EXPECT_EQ(shared.getOrLoad(key, countingGetPage), key * 10);
+    EXPECT_EQ(loads, 0);
+    EXPECT_EQ(shared.size(), 32);
+
+    cache::SharedLFUCache<int, int, 128> otherLayout;
+    EXPECT_FALSE(otherLayout.open(name));
+    cache::SharedLFUCache<float, int, 64> otherType; // same sizes
+    EXPECT_FALSE(otherType.open(name));
+
+    EXPECT_TRUE(SharedCache::unlink(name));
+}
+
+TEST(SharedLFU, DeadLockOwnerResetsCache) {
+    std::string name = sharedName("dead");
+    SharedCache shared;
+    ASSERT_TRUE(shared.open(name));
+    for (int key = 0; key < 8; ++key)
+        shared.lookupUpdate(key, [](int k) { return k; });
+
+    // Dies in the middle of a critical section.
+    runInChild([&] {
+        SharedCache worker;
+        if (worker.open(name))
+            worker.withLock([](auto &) { _exit(0); });
+        return 1;
+    });
+
+    EXPECT_FALSE(shared.lookupUpdate(0, [](int k) { return k; }));
+    EXPECT_EQ(shared.recoveries(), 1);
+    EXPECT_EQ(shared.size(), 1);
+
+    EXPECT_TRUE(SharedCache::unlink(name));
+}
+
+TEST(SharedLFU, StaleSegmentIsRecreated) {
+    std::string name = sharedName("stale");
+    using Segment =
+        cache::SharedLFUSegment<cache::StaticLFUCache<int, int, 64>>;
+
+    // The creator died before sizing the segment: found by the timeout.
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    {
+        SharedCache shared;
+        ASSERT_TRUE(shared.open(name));
+        shared.lookupUpdate(1, [](int k) { return k; });
+        EXPECT_EQ(shared.size(), 1);
+    }
+    EXPECT_TRUE(SharedCache::unlink(name));
+
+    // The creator died after writing its pid: found right away.
+    pid_t dead = fork();
+    if (dead == 0)
+        _exit(0);
+    ASSERT_EQ(waitpid(dead, nullptr, 0), dead);
+
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, sizeof(Segment)), 0);
+    void *addr = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(addr, MAP_FAILED);
+    static_cast<Segment *>(addr)->creator_ = static_cast<uint64_t>(dead);
+    munmap(addr, sizeof(Segment));
+
+    auto start = std::chrono::steady_clock::now();
+    SharedCache shared;
+    ASSERT_TRUE(shared.open(name));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(1));
+    EXPECT_EQ(shared.size(), 0);
+
+    EXPECT_TRUE(SharedCache::unlink(name));
+}
+
+TEST(SharedLFU, MatchesStaticLFUCache) {
+    const int QUERIES_COUNT = 5000;
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, -100, 100);
+    auto getPage = [](int key) { return key; };
+
+    std::string name = sharedName("match");
+    SharedCache shared;
+    ASSERT_TRUE(shared.open(name));
+    cache::StaticLFUCache<int, int, 64> local;
+
+    int shared_hits =
+        countCacheHits(shared, queries.begin(), queries.end(), getPage);
+    int local_hits =
+        countCacheHits(local, queries.begin(), queries.end(), getPage);
+    EXPECT_EQ(shared_hits, local_hits);
+
+    EXPECT_TRUE(SharedCache::unlink(name));
+}
+
+#endif // CACHE_HAS_SHARED_MEMORY
+
+// ---------------- Online Belady tests ----------------
+
+TEST(OnlineBelady, FullWindowMatchesBelady) {
+    const size_t CACHE_CAPACITY = 16;
+    const int QUERIES_COUNT = 5000;
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, 0, 100);
+
+    cache::BeladyCache<test::Page, int> Belady(CACHE_CAPACITY, queries.begin(),
+                                               queries.end());
+    cache::OnlineBeladyCache<test::Page, int> online(
+        CACHE_CAPACITY, QUERIES_COUNT, queries.begin(), queries.end());
+
+    int Belady_hits = countCacheHits(Belady, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+    int online_hits = countCacheHits(online, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+    EXPECT_EQ(online_hits, Belady_hits);
+}
+
+TEST(OnlineBelady, EmptyWindowMatchesLFU) {
+    const size_t CACHE_CAPACITY = 16;
+    const int QUERIES_COUNT = 5000;
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, 0, 100);
+
+    cache::LFUCache<test::Page, int> lfu(CACHE_CAPACITY);
+    cache::OnlineBeladyCache<test::Page, int> online(
+        CACHE_CAPACITY, 0, queries.begin(), queries.end());
+
+    int lfu_hits =
+        countCacheHits(lfu, queries.begin(), queries.end(), test::slowGetPage);
+    int online_hits = countCacheHits(online, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+    EXPECT_EQ(online_hits, lfu_hits);
+}
+
+TEST(OnlineBelady, ReadsFromStream) {
+    std::istringstream stream("1 2 3 1 2 4 1 2 5 1 2");
+    std::vector<int> queries = {1, 2, 3, 1, 2, 4, 1, 2, 5, 1, 2};
+
+    cache::OnlineBeladyCache<int, int> online(
+        2, 3, std::istream_iterator<int>(stream), std::istream_iterator<int>());
+
+    // 3, 4 and 5 are never used again inside the window and bypass.
+    int hits = countCacheHits(online, queries.begin(), queries.end(),
+                              [](int key) { return key; });
+    EXPECT_EQ(hits, 6);
+    EXPECT_EQ(online.size(), 2);
+}
+
+TEST(Compare, OnlineBeladyWindowSweep) {
+    const size_t CACHE_CAPACITY = 64;
+    const int QUERIES_COUNT = 20000;
+    std::vector<int> queries = uniformQueries(QUERIES_COUNT, 0, 400);
+
+    cache::BeladyCache<test::Page, int> Belady(CACHE_CAPACITY, queries.begin(),
+                                               queries.end());
+    int Belady_hits = countCacheHits(Belady, queries.begin(), queries.end(),
+                                     test::slowGetPage);
+
+    std::cout << "[OnlineBeladyWindowSweep] Belady_hits=" << Belady_hits
+              << " of " << QUERIES_COUNT << '\n';
+
+    int prev_hits = 0;
+    for (size_t window : {0, 64, 256, 1024, 4096, 20000}) {
+        cache::OnlineBeladyCache<test::Page, int> online(
+            CACHE_CAPACITY, window, queries.begin(), queries.end());
+        int online_hits = countCacheHits(online, queries.begin(),
+                                         queries.end(), test::slowGetPage);
+
+        std::cout << "[OnlineBeladyWindowSweep] window=" << window
+                  << " hits=" << online_hits << '\n';
+
+        EXPECT_LE(online_hits, Belady_hits);
+        EXPECT_GE(online_hits, prev_hits);
+        prev_hits = online_hits;
+    }
+    EXPECT_EQ(prev_hits, Belady_hits);
+}